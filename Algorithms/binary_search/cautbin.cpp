@@ -1,12 +1,42 @@
 #include <algorithm>
 #include <cassert>
+#include <climits>
 #include <cmath>
+#include <cstdint>
 #include <cstring>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef BENCHMARK
+// The benchmark reports its timings through the Profiling class.
+#ifndef PROFILING
+#define PROFILING
+#endif
+#include <random>
+#include <string>
+#endif
+
+#ifdef VERIFY
+#include <random>
+#endif
+
 #ifdef PROFILING
 #include <chrono>
 #endif
@@ -14,6 +44,22 @@
 constexpr char INPUT_FILE_NAME[]  = "cautbin.in";
 constexpr char OUTPUT_FILE_NAME[] = "cautbin.out";
 
+// Binary sorted array written by -DCONVERT_INPUT and searched in place by -DMAPPED_INPUT.
+constexpr char SORTED_ARRAY_FILE_NAME[] = "cautbin.bin";
+// The query section of cautbin.in, split off by -DCONVERT_INPUT and read by -DMAPPED_INPUT.
+constexpr char QUERIES_FILE_NAME[] = "cautbin.queries";
+
+// Arrays larger than this (in bytes) are searched through the S_Tree_Index.
+constexpr std::size_t L2_CACHE_SIZE = 1 << 20;
+
+// Queries are read and searched in groups of BATCH_SIZE, so their memory accesses overlap.
+constexpr unsigned int BATCH_SIZE = 32;
+
+/* With at least array_size / OFFLINE_QUERY_RATIO queries, sorting them and sweeping
+ * the array once costs less than searching for each of them.
+ */
+constexpr unsigned int OFFLINE_QUERY_RATIO = 4;
+
 class IO_Base
 {
     protected:
@@ -213,61 +259,37 @@ class Profiling
 };
 #endif
 
-unsigned int log2_32(uint32_t value)
-{
-    constexpr int tab32[32] = {
-        0,
-        9,
-        1,
-        10,
-        13,
-        21,
-        2,
-        29,
-        11,
-        14,
-        16,
-        18,
-        22,
-        25,
-        3,
-        30,
-        8,
-        12,
-        20,
-        28,
-        15,
-        17,
-        24,
-        7,
-        19,
-        27,
-        23,
-        6,
-        26,
-        5,
-        4,
-        31
-    };
+/* Highest power of two <= _value (0 for 0), i.e. the first step of the step search.
+ * The leading zero count is a single instruction (lzcnt, or bsr on older CPUs).
+ * There is one overload per index width, so 32-bit arrays keep 32-bit arithmetic
+ * and arrays of 2^32 or more elements get the full 64 bits.
+ */
+std::uint32_t bit_floor(const std::uint32_t _value)
+{
+    return _value ? std::uint32_t{1} << (31 - __builtin_clz(_value)) : 0;
+}
 
-    value |= value >> 1;
-    value |= value >> 2;
-    value |= value >> 4;
-    value |= value >> 8;
-    value |= value >> 16;
-    return tab32[value * 0x07C4ACDD >> 27];
+std::uint64_t bit_floor(const std::uint64_t _value)
+{
+    return _value ? std::uint64_t{1} << (63 - __builtin_clzll(_value)) : 0;
 }
 
-unsigned int binary_search(const std::vector<int>& numbers,
-                           const int               _value,
-                           const unsigned int      lower_bound,
-                           const unsigned int      upper_bound,
-                           unsigned int            step)
+/* Step (power-of-two) search over numbers[lower_bound .. upper_bound], 1-based.
+ * Index is the width of the positions: std::uint32_t for arrays below 2^32 elements,
+ * std::uint64_t for bigger (e.g. memory-mapped) ones. The bound checks are written as
+ * step <= upper_bound - index so they cannot overflow at the top of either range.
+ */
+template <class Index>
+Index binary_search(const int* const numbers,
+                    const int        _value,
+                    const Index      lower_bound,
+                    const Index      upper_bound,
+                    Index            step)
 {
-    unsigned int index = lower_bound;
+    Index index = lower_bound;
     while (step)
     {
-        if (index + step <= upper_bound && numbers[index + step] <= _value)
+        if (step <= upper_bound - index && numbers[index + step] <= _value)
         {
             index += step;
         }
@@ -277,16 +299,17 @@ unsigned int binary_search(const std::vector<int>& numbers,
     return index;
 }
 
-unsigned int reverse_binary_search(const std::vector<int>& numbers,
-                                   const int               _value,
-                                   const unsigned int      lower_bound,
-                                   const unsigned int      upper_bound,
-                                   unsigned int            step)
+template <class Index>
+Index reverse_binary_search(const int* const numbers,
+                            const int        _value,
+                            const Index      lower_bound,
+                            const Index      upper_bound,
+                            Index            step)
 {
-    unsigned int index = upper_bound;
+    Index index = upper_bound;
     while (step)
     {
-        if (index >= lower_bound + step && numbers[index - step] >= _value)
+        if (index - lower_bound >= step && numbers[index - step] >= _value)
         {
             index -= step;
         }
@@ -296,79 +319,1799 @@ unsigned int reverse_binary_search(const std::vector<int>& numbers,
     return index;
 }
 
-int main()
+/* A batched search answers every query as "how many keys are <= threshold",
+ * so that all the searches in a batch take the same path through the code.
+ * Types 0 and 1 ask exactly that for their value. Type 2 asks how many keys are < value,
+ * which is the number of keys <= value - 1.
+ * The two values this cannot express (INT_MIN for type 2, INT_MAX for types 0 and 1)
+ * get a harmless threshold here and their answer from Batch_Position.
+ */
+int Batch_Threshold(const short _type, const int _value)
 {
-    #ifdef PROFILING
-    Profiling profiling = Profiling(__PRETTY_FUNCTION__);
-    #endif
+    if (_type == 2)
+    {
+        return _value == INT_MIN ? INT_MIN : _value - 1;
+    }
 
-    IO& io = IO::GetInstance(INPUT_FILE_NAME, OUTPUT_FILE_NAME);
+    return _value == INT_MAX ? INT_MAX - 1 : _value;
+}
 
-    unsigned int array_size;
-    io.IN >> array_size; // 1 ≤ array_size ≤ 100 000
+// Turns the number of keys <= Batch_Threshold(_type, _value) into the 1-based position main() prints.
+std::size_t Batch_Position(const short _type, const int _value, const std::size_t _keys_at_most, const std::size_t _size)
+{
+    if (_type == 2)
+    {
+        // The first key >= _value follows the _keys_at_most keys < _value.
+        if (_value == INT_MIN)
+        {
+            return 1;
+        }
+        return _keys_at_most < _size ? _keys_at_most + 1 : _size;
+    }
 
-    std::vector<int> numbers(array_size + 1); // INT_MIN ≤ numbers[i] ≤ INT_MAX; numbers[i] <= numbers[i+1]
-    for (unsigned int i = 1; i <= array_size; i++)
+    // The last key <= _value is the _keys_at_most-th.
+    if (_value == INT_MAX)
     {
-        io.IN >> numbers[i];
+        return _size;
     }
+    return _keys_at_most ? _keys_at_most : 1;
+}
 
-    const unsigned int log2_array_size = log2_32(array_size);
-    const unsigned int max_step        = 1 << log2_array_size;
+/* search: lower_bound, upper_bound, equal_range, last_less_or_equal and first_greater_or_equal
+ * over a sorted, 0-based range of any key type with a strict weak ordering Compare
+ * (int32_t, int64_t, uint64_t, float without NaNs, Fixed_String, ...).
+ * Every function returns a 0-based index into the sorted range, or NOT_FOUND.
+ * Everything here is a template, so the namespace can be lifted into any other task as it is.
+ * Eytzinger_Index, Learned_Index, Finger_Index, Sorted_Array_Index and the offline sweep are built on it;
+ * S_Tree_Index keeps its own layout of ints, which is also the index section of cautbin.bin.
+ * -DVERIFY checks all of it against std::lower_bound and std::upper_bound, for each of the key types above.
+ */
+namespace search
+{
+    constexpr std::size_t NOT_FOUND = static_cast<std::size_t>(-1);
+    constexpr std::size_t CACHE_LINE_SIZE = 64;
 
-    unsigned int queries_count; // 1 ≤ queries_count ≤ 100 000
-    io.IN >> queries_count;
+    // Fixed-length (e.g. zero-padded) string keys, ordered byte by byte.
+    template <std::size_t LENGTH>
+    struct Fixed_String
+    {
+        char chars[LENGTH];
 
-    while (queries_count--)
+        bool operator<(const Fixed_String& _rhs) const
+        {
+            return std::memcmp(chars, _rhs.chars, LENGTH) < 0;
+        }
+    };
+
+    /* A branchless search turns every comparison into a conditional move, which only pays off
+     * when a comparison is a single instruction. Other keys (a Fixed_String compare is a memcmp)
+     * are searched with branches, which at least lets the CPU speculate past the comparison.
+     */
+    template <class Key>
+    struct Is_Branchless : std::integral_constant<bool, std::is_arithmetic<Key>::value>
     {
-        short query_type;  // 0 ≤ query_type ≤ 2
-        int   query_value; // INT_MIN ≤ query_value ≤ INT_MAX
-        io.IN >> query_type >> query_value;
+    };
+
+    namespace detail
+    {
+        // Index of the first key for which _before(key) is false. The keys must be partitioned by _before.
+        template <class Key, class Predicate>
+        std::size_t partition_point(const Key* const _keys, std::size_t _size, Predicate _before, std::true_type /* branchless */)
+        {
+            if (_size == 0)
+            {
+                return 0;
+            }
+
+            const Key* base = _keys;
+            while (_size > 1)
+            {
+                const std::size_t half = _size / 2;
+                // Multiplying instead of selecting keeps GCC from compiling this back into a branch.
+                base += static_cast<std::size_t>(_before(base[half - 1])) * half;
+                _size -= half;
+            }
+
+            return static_cast<std::size_t>(base - _keys) + _before(*base);
+        }
+
+        template <class Key, class Predicate>
+        std::size_t partition_point(const Key* const _keys, std::size_t _size, Predicate _before, std::false_type /* branchless */)
+        {
+            std::size_t first = 0;
+            while (_size > 0)
+            {
+                const std::size_t half = _size / 2;
+                if (_before(_keys[first + half]))
+                {
+                    first += half + 1;
+                    _size -= half + 1;
+                }
+                else
+                {
+                    _size = half;
+                }
+            }
+
+            return first;
+        }
+
+        /* Galloping (exponential) search for the partition point, starting from _hint:
+         * probe _hint + 1, _hint + 2, _hint + 4, ... (or the same to the left) until the
+         * partition point is bracketed, then binary search the last gap.
+         * Costs O(log distance) between _hint and the answer instead of O(log _size).
+         */
+        template <class Key, class Predicate, class Branchless>
+        std::size_t gallop(const Key* const _keys, const std::size_t _size, std::size_t _hint, Predicate _before, Branchless _branchless)
+        {
+            _hint = std::min(_hint, _size);
+
+            std::size_t bound = 1;
+            if (_hint < _size && _before(_keys[_hint]))
+            {
+                // The answer is right of _hint.
+                while (_hint + bound < _size && _before(_keys[_hint + bound]))
+                {
+                    bound *= 2;
+                }
 
-        switch (query_type)
+                const std::size_t first = _hint + bound / 2 + 1;
+                const std::size_t last  = std::min(_hint + bound, _size);
+                return first + partition_point(_keys + first, last - first, _before, _branchless);
+            }
+
+            // The answer is _hint or left of it.
+            while (bound <= _hint && _before(_keys[_hint - bound]) == false)
+            {
+                bound *= 2;
+            }
+
+            const std::size_t first = bound <= _hint ? _hint - bound + 1 : 0;
+            const std::size_t last  = _hint - bound / 2;
+            return first + partition_point(_keys + first, last - first, _before, _branchless);
+        }
+
+        // Largest power of two number of keys that fits in a cache line (0 if a key is larger than a line).
+        constexpr std::size_t keys_per_cache_line(const std::size_t _key_size)
         {
-            case 0:
+            std::size_t keys = 1;
+            while (keys * 2 * _key_size <= CACHE_LINE_SIZE)
+            {
+                keys *= 2;
+            }
+
+            return keys * _key_size <= CACHE_LINE_SIZE ? keys : 0;
+        }
+    }
+
+    // First key >= _value (or _size).
+    template <class Key, class Compare = std::less<Key>>
+    std::size_t lower_bound(const Key* const _keys, const std::size_t _size, const Key& _value, Compare _compare = Compare())
+    {
+        return detail::partition_point(_keys,
+                                       _size,
+                                       [&](const Key& _key) { return _compare(_key, _value); },
+                                       typename Is_Branchless<Key>::type());
+    }
+
+    // First key > _value (or _size).
+    template <class Key, class Compare = std::less<Key>>
+    std::size_t upper_bound(const Key* const _keys, const std::size_t _size, const Key& _value, Compare _compare = Compare())
+    {
+        return detail::partition_point(_keys,
+                                       _size,
+                                       [&](const Key& _key) { return !_compare(_value, _key); },
+                                       typename Is_Branchless<Key>::type());
+    }
+
+    template <class Key, class Compare = std::less<Key>>
+    std::pair<std::size_t, std::size_t> equal_range(const Key* const _keys,
+                                                    const std::size_t _size,
+                                                    const Key&        _value,
+                                                    Compare           _compare = Compare())
+    {
+        return {lower_bound(_keys, _size, _value, _compare), upper_bound(_keys, _size, _value, _compare)};
+    }
+
+    template <class Key, class Compare = std::less<Key>>
+    std::size_t last_less_or_equal(const Key* const _keys, const std::size_t _size, const Key& _value, Compare _compare = Compare())
+    {
+        const std::size_t index = upper_bound(_keys, _size, _value, _compare);
+        return index ? index - 1 : NOT_FOUND;
+    }
+
+    template <class Key, class Compare = std::less<Key>>
+    std::size_t first_greater_or_equal(const Key* const _keys, const std::size_t _size, const Key& _value, Compare _compare = Compare())
+    {
+        const std::size_t index = lower_bound(_keys, _size, _value, _compare);
+        return index < _size ? index : NOT_FOUND;
+    }
+
+    // lower_bound, galloping from _hint (typically the previous answer).
+    template <class Key, class Compare = std::less<Key>>
+    std::size_t gallop_lower_bound(const Key* const  _keys,
+                                   const std::size_t _size,
+                                   const Key&        _value,
+                                   const std::size_t _hint,
+                                   Compare           _compare = Compare())
+    {
+        return detail::gallop(_keys,
+                              _size,
+                              _hint,
+                              [&](const Key& _key) { return _compare(_key, _value); },
+                              typename Is_Branchless<Key>::type());
+    }
+
+    // upper_bound, galloping from _hint (typically the previous answer).
+    template <class Key, class Compare = std::less<Key>>
+    std::size_t gallop_upper_bound(const Key* const  _keys,
+                                   const std::size_t _size,
+                                   const Key&        _value,
+                                   const std::size_t _hint,
+                                   Compare           _compare = Compare())
+    {
+        return detail::gallop(_keys,
+                              _size,
+                              _hint,
+                              [&](const Key& _key) { return !_compare(_value, _key); },
+                              typename Is_Branchless<Key>::type());
+    }
+
+    /* Eytzinger: a copy of the sorted keys stored in BFS (heap) order, answering the same queries.
+     * tree[1] is the root and the children of tree[k] are tree[2k] and tree[2k + 1].
+     * The top levels of the tree are packed together at the start of the array,
+     * so they stay in cache, and the descent is a plain index computation that
+     * the compiler turns into a conditional move instead of a branch.
+     * With PREFETCH_STRIDE keys per cache line, the PREFETCH_STRIDE descendants of tree[k]
+     * log2(PREFETCH_STRIDE) levels down (16 ints four levels down) share one line.
+     * We prefetch it while we are still comparing against tree[k], hiding most of the memory latency.
+     * Position is the type the sorted index of each node is stored as; unsigned int halves
+     * the memory of that table whenever the range has fewer than 2^32 keys.
+     */
+    template <class Key, class Compare = std::less<Key>, class Position = std::size_t>
+    class Eytzinger
+    {
+        private:
+            static constexpr std::size_t PREFETCH_STRIDE = detail::keys_per_cache_line(sizeof(Key));
+            static constexpr std::size_t BATCH_SIZE      = 32;
+
+            const std::size_t     size;
+            const unsigned int    height;    // number of levels of the tree
+            const Compare         compare;
+            std::vector<Key>      storage;   // backing memory, over-allocated so tree can be aligned
+            Key*                  tree;      // tree[1..size]; tree[0] is a dummy slot
+            std::vector<Position> positions; // positions[k]: 0-based index of tree[k] in the sorted range
+
+            // In-order traversal of the implicit tree assigns the sorted keys to it.
+            std::size_t Build(const Key* const _keys, std::size_t _next, const std::size_t _k)
+            {
+                if (_k <= size)
+                {
+                    _next         = Build(_keys, _next, 2 * _k);
+                    tree[_k]      = _keys[_next];
+                    positions[_k] = static_cast<Position>(_next++);
+                    _next         = Build(_keys, _next, 2 * _k + 1);
+                }
+
+                return _next;
+            }
+
+            bool Goes_Right(const std::size_t _k, const Key& _value, const bool _inclusive) const
+            {
+                return _inclusive ? !compare(_value, tree[_k]) : compare(tree[_k], _value);
+            }
+
+            /* Branchless descent. Returns the sorted index of the first key
+             * greater than _value (_inclusive) or greater or equal than _value (!_inclusive), or size.
+             */
+            std::size_t Descend(const Key& _value, const bool _inclusive) const
+            {
+                std::size_t k = 1;
+                while (k <= size)
+                {
+                    if (PREFETCH_STRIDE > 1)
+                    {
+                        __builtin_prefetch(tree + k * PREFETCH_STRIDE);
+                    }
+                    k = 2 * k + Goes_Right(k, _value, _inclusive);
+                }
+
+                // The answer is where we last turned left: drop the trailing right turns plus that left turn.
+                k >>= __builtin_ctzll(~k) + 1;
+                return k ? positions[k] : size;
+            }
+
+        public:
+            Eytzinger(const Key* const _keys, const std::size_t _size, Compare _compare = Compare())
+                : size(_size),
+                  height(_size ? static_cast<unsigned int>(64 - __builtin_clzll(_size)) : 0),
+                  compare(_compare),
+                  storage(_size + 1 + CACHE_LINE_SIZE / sizeof(Key)),
+                  positions(_size + 1)
+            {
+                // Align tree to a cache line whenever keys tile it exactly.
+                const std::size_t misalignment = reinterpret_cast<std::uintptr_t>(storage.data()) % CACHE_LINE_SIZE;
+                const bool        alignable    = CACHE_LINE_SIZE % sizeof(Key) == 0 && misalignment % sizeof(Key) == 0;
+                tree = storage.data() + (alignable ? (CACHE_LINE_SIZE - misalignment) % CACHE_LINE_SIZE / sizeof(Key) : 0);
+                Build(_keys, 0, 1);
+            }
+
+            std::size_t Lower_Bound(const Key& _value) const
+            {
+                return Descend(_value, false);
+            }
+
+            std::size_t Upper_Bound(const Key& _value) const
+            {
+                return Descend(_value, true);
+            }
+
+            std::pair<std::size_t, std::size_t> Equal_Range(const Key& _value) const
+            {
+                return {Lower_Bound(_value), Upper_Bound(_value)};
+            }
+
+            std::size_t Last_Less_Or_Equal(const Key& _value) const
+            {
+                const std::size_t index = Upper_Bound(_value);
+                return index ? index - 1 : NOT_FOUND;
+            }
+
+            std::size_t First_Greater_Or_Equal(const Key& _value) const
+            {
+                const std::size_t index = Lower_Bound(_value);
+                return index < size ? index : NOT_FOUND;
+            }
+
+            /* Upper_Bound of _count values, answered BATCH_SIZE at a time: all the searches of a batch
+             * move down one level before any of them moves down the next, so up to BATCH_SIZE
+             * cache misses are in flight at once. Searches that reach the bottom early
+             * (the last level is not full) simply stop moving.
+             */
+            void Upper_Bound_Batch(const Key* const _values, const std::size_t _count, std::size_t* const _indexes) const
+            {
+                for (std::size_t first = 0; first < _count; first += BATCH_SIZE)
                 {
-                    // Find the first occurrence of query_value in the array.
-                    // If it exists, return the position of the last occurrence.
-                    // If it doesn't exist, return -1.
-                    const unsigned int position = binary_search(numbers, query_value, 1, array_size, max_step);
-                    if (numbers[position] != query_value)
+                    const std::size_t batch_size = std::min(BATCH_SIZE, _count - first);
+                    const Key* const  values     = _values + first;
+
+                    std::size_t k[BATCH_SIZE];
+                    std::fill(k, k + batch_size, 1);
+
+                    for (unsigned int level = 0; level < height; level++)
                     {
-                        io.OUT << "-1\n";
+                        for (std::size_t i = 0; i < batch_size; i++)
+                        {
+                            // tree[0] is a dummy slot, so finished searches can read it instead of branching.
+                            const std::size_t current = k[i] <= size ? k[i] : 0;
+                            if (PREFETCH_STRIDE > 1)
+                            {
+                                __builtin_prefetch(tree + current * PREFETCH_STRIDE);
+                            }
+                            const std::size_t next = 2 * current + Goes_Right(current, values[i], true);
+                            k[i]                   = k[i] <= size ? next : k[i];
+                        }
                     }
-                    else
+
+                    for (std::size_t i = 0; i < batch_size; i++)
                     {
-                        io.OUT << position << '\n';
+                        const std::size_t first_greater = k[i] >> (__builtin_ctzll(~k[i]) + 1);
+                        _indexes[first + i]             = first_greater ? positions[first_greater] : size;
                     }
-                    break;
                 }
-            case 1:
+            }
+    };
+
+    // Definitions for the in-class constants, which std::min and the like take by reference (ODR-use).
+    template <class Key, class Compare, class Position>
+    constexpr std::size_t Eytzinger<Key, Compare, Position>::PREFETCH_STRIDE;
+
+    template <class Key, class Compare, class Position>
+    constexpr std::size_t Eytzinger<Key, Compare, Position>::BATCH_SIZE;
+}
+
+/* Eytzinger_Index: cautbin's 1-based query semantics on top of search::Eytzinger.
+ * Like every index below, it is a template over Position, the width of its positions (see binary_search):
+ * std::uint32_t for arrays below 2^32 elements, std::uint64_t for bigger ones.
+ */
+template <class Position>
+class Eytzinger_Index
+{
+    private:
+        const Position                                         size;
+        const search::Eytzinger<int, std::less<int>, Position> index;
+
+    public:
+        // _numbers is 1-based (_numbers[0] is unused), as read by main().
+        Eytzinger_Index(const std::vector<int>& _numbers, const Position _size)
+            : size(_size), index(_numbers.data() + 1, _size)
+        {
+        }
+
+        // Same result as binary_search(numbers, _value, 1, size, max_step).
+        Position Last_Less_Or_Equal(const int _value) const
+        {
+            const std::size_t index_found = index.Last_Less_Or_Equal(_value);
+            return index_found == search::NOT_FOUND ? 1 : static_cast<Position>(index_found + 1);
+        }
+
+        // Same result as reverse_binary_search(numbers, _value, 1, size, max_step).
+        Position First_Greater_Or_Equal(const int _value) const
+        {
+            const std::size_t index_found = index.First_Greater_Or_Equal(_value);
+            return index_found == search::NOT_FOUND ? size : static_cast<Position>(index_found + 1);
+        }
+
+        // Answers _count ≤ BATCH_SIZE queries together (see search::Eytzinger::Upper_Bound_Batch).
+        void Search_Batch(const short* const  _types,
+                          const int* const    _values,
+                          const unsigned int  _count,
+                          std::size_t* const  _positions) const
+        {
+            int         threshold[BATCH_SIZE];
+            std::size_t keys_at_most[BATCH_SIZE];
+            for (unsigned int i = 0; i < _count; i++)
+            {
+                threshold[i] = Batch_Threshold(_types[i], _values[i]);
+            }
+
+            index.Upper_Bound_Batch(threshold, _count, keys_at_most);
+
+            for (unsigned int i = 0; i < _count; i++)
+            {
+                _positions[i] = Batch_Position(_types[i], _values[i], keys_at_most[i], size);
+            }
+        }
+};
+
+/* S_Tree_Index: a static B+ tree with 16 keys per node (one cache line of ints).
+ * Layer 0 holds the sorted array itself, padded with INT_MAX to whole nodes.
+ * Every layer above holds, for each child but the first, the smallest key of
+ * that child's subtree, so node b of a layer has children b * 17 .. b * 17 + 16
+ * in the layer below. A lookup touches one cache line per layer (log_17 n lines,
+ * against log_2 n for the step loop) and picks the child by counting the keys
+ * smaller than the value, which is a compare + movemask + popcount with AVX2.
+ * The tree is a single block of ints, so it can also be stored in (and mapped from) a file.
+ * Its layout does not depend on Position, which only has to hold Tree_Keys(size).
+ */
+template <class Position>
+class S_Tree_Index
+{
+    private:
+        static constexpr unsigned int CACHE_LINE_SIZE = 64;
+        static constexpr unsigned int NODE_KEYS       = CACHE_LINE_SIZE / sizeof(int); // 16
+
+        const Position            size;
+        std::vector<int>          storage;       // backing memory, over-allocated so the layers can be aligned (empty if mapped)
+        const int*                tree;          // all layers, bottom-up, aligned to a cache line
+        std::vector<std::size_t>  layer_offsets; // layer_offsets[h]: index in tree of the first key of layer h
+
+        static std::size_t Nodes(const std::size_t _keys)
+        {
+            return (_keys + NODE_KEYS - 1) / NODE_KEYS;
+        }
+
+        // Number of keys (a whole number of nodes) the layer above a layer of _keys keys needs.
+        static std::size_t Parent_Keys(const std::size_t _keys)
+        {
+            return (Nodes(_keys) + NODE_KEYS) / (NODE_KEYS + 1) * NODE_KEYS;
+        }
+
+        // Offsets of every layer in the tree of _size keys, followed by the total number of ints.
+        static std::vector<std::size_t> Layout(const std::size_t _size)
+        {
+            std::vector<std::size_t> offsets;
+            std::size_t              total_keys = 0;
+            for (std::size_t keys = _size; ; keys = Parent_Keys(keys))
+            {
+                offsets.push_back(total_keys);
+                total_keys += Nodes(keys) * NODE_KEYS;
+                if (keys <= NODE_KEYS)
                 {
-                    // Find the last number smaller or equal than query_value.
-                    const unsigned int position = binary_search(numbers, query_value, 1, array_size, max_step);
-                    io.OUT << position << '\n';
                     break;
                 }
-            case 2:
+            }
+
+            offsets.push_back(total_keys);
+            return offsets;
+        }
+
+        // Wraps a tree already laid out in memory (see From_Tree).
+        S_Tree_Index(const int* const _tree, const Position _size, const bool /* built */)
+            : size(_size), tree(_tree), layer_offsets(Layout(_size))
+        {
+            layer_offsets.pop_back();
+        }
+
+        /* Number of keys in the node at _node that are smaller than _value (!INCLUSIVE)
+         * or smaller or equal than _value (INCLUSIVE). Keys are sorted, so this is also
+         * the index of the child to descend into.
+         */
+        template <bool INCLUSIVE>
+        static unsigned int Rank(const int* const _node, const int _value)
+        {
+            #ifdef __AVX2__
+            const __m256i value = _mm256_set1_epi32(_value);
+            const __m256i low   = _mm256_load_si256(reinterpret_cast<const __m256i*>(_node));
+            const __m256i high  = _mm256_load_si256(reinterpret_cast<const __m256i*>(_node + 8));
+
+            // keys < value is value > keys; keys <= value is the complement of keys > value.
+            const __m256i low_mask  = INCLUSIVE ? _mm256_cmpgt_epi32(low, value) : _mm256_cmpgt_epi32(value, low);
+            const __m256i high_mask = INCLUSIVE ? _mm256_cmpgt_epi32(high, value) : _mm256_cmpgt_epi32(value, high);
+
+            // Packing narrows each 32-bit lane to 16 bits, so every key contributes two bits to the mask.
+            const unsigned int mask  = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_packs_epi32(low_mask, high_mask)));
+            const unsigned int count = static_cast<unsigned int>(__builtin_popcount(mask)) >> 1;
+            return INCLUSIVE ? NODE_KEYS - count : count;
+            #else
+            unsigned int count = 0;
+            for (unsigned int i = 0; i < NODE_KEYS; i++)
+            {
+                count += INCLUSIVE ? _node[i] <= _value : _node[i] < _value;
+            }
+            return count;
+            #endif
+        }
+
+        // 0-based index of the first key greater than (INCLUSIVE) or greater or equal than (!INCLUSIVE) _value.
+        template <bool INCLUSIVE>
+        Position Descend(const int _value) const
+        {
+            Position node = 0;
+            for (std::size_t h = layer_offsets.size() - 1; h > 0; h--)
+            {
+                node = node * (NODE_KEYS + 1) + Rank<INCLUSIVE>(tree + layer_offsets[h] + node * NODE_KEYS, _value);
+            }
+
+            return node * NODE_KEYS + Rank<INCLUSIVE>(tree + node * NODE_KEYS, _value);
+        }
+
+    public:
+        // Number of ints the tree of _size keys takes: the keys padded to whole nodes, then the layers above them.
+        static std::size_t Tree_Keys(const std::size_t _size)
+        {
+            return Layout(_size).back();
+        }
+
+        /* Builds the tree in place: _tree[0 .. _size) must hold the sorted keys and have room for
+         * Tree_Keys(_size) ints. Pads the keys to whole nodes and fills in the layers above them.
+         */
+        static void Build_Layers(int* const _tree, const std::size_t _size)
+        {
+            const std::vector<std::size_t> offsets = Layout(_size);
+            std::fill(_tree + _size, _tree + offsets[1], INT_MAX);
+
+            for (std::size_t h = 1; h + 1 < offsets.size(); h++)
+            {
+                for (std::size_t i = 0; i < offsets[h + 1] - offsets[h]; i++)
                 {
-                    // Find the first number greater or equal than query_value.
-                    const unsigned int position = reverse_binary_search(numbers,
-                                                                        query_value,
-                                                                        1,
-                                                                        array_size,
-                                                                        max_step);
-                    io.OUT << position << '\n';
-                    break;
+                    // Key i of its node separates child i from child i + 1: it is the leftmost key under child i + 1.
+                    std::size_t node = i / NODE_KEYS * (NODE_KEYS + 1) + i % NODE_KEYS + 1;
+                    for (std::size_t level = 1; level < h; level++)
+                    {
+                        node *= NODE_KEYS + 1;
+                    }
+
+                    _tree[offsets[h] + i] = node * NODE_KEYS < _size ? _tree[node * NODE_KEYS] : INT_MAX;
                 }
-            default:
+            }
+        }
+
+        /* Searches a tree built by Build_Layers without copying it, e.g. one mapped from a file.
+         * _tree must be aligned to a cache line and outlive the index.
+         */
+        static S_Tree_Index From_Tree(const int* const _tree, const Position _size)
+        {
+            return S_Tree_Index(_tree, _size, true);
+        }
+
+        // _numbers is 1-based (_numbers[0] is unused), as read by main().
+        S_Tree_Index(const std::vector<int>& _numbers, const Position _size)
+            : S_Tree_Index(_numbers.data() + 1, _size)
+        {
+        }
+
+        // Copies the sorted _keys (0-based) and builds the tree over them.
+        S_Tree_Index(const int* const _keys, const Position _size)
+            : size(_size), layer_offsets(Layout(_size))
+        {
+            const std::size_t total_keys = layer_offsets.back();
+            layer_offsets.pop_back();
+
+            storage.resize(total_keys + NODE_KEYS);
+            const std::size_t misalignment = reinterpret_cast<std::uintptr_t>(storage.data()) % CACHE_LINE_SIZE;
+            int* const        aligned_tree = storage.data() + (misalignment ? (CACHE_LINE_SIZE - misalignment) / sizeof(int) : 0);
+
+            std::copy(_keys, _keys + _size, aligned_tree);
+            Build_Layers(aligned_tree, _size);
+            tree = aligned_tree;
+        }
+
+        // Same result as binary_search(numbers, _value, 1, size, max_step).
+        Position Last_Less_Or_Equal(const int _value) const
+        {
+            // The INT_MAX padding would count as <= INT_MAX; every key is, so the answer is the last one.
+            const Position position = _value == INT_MAX ? size : Descend<true>(_value);
+            return position ? position : 1;
+        }
+
+        // Same result as reverse_binary_search(numbers, _value, 1, size, max_step).
+        Position First_Greater_Or_Equal(const int _value) const
+        {
+            const Position index = Descend<false>(_value);
+            return index < size ? index + 1 : size;
+        }
+
+        /* Answers _count ≤ BATCH_SIZE queries together, one layer at a time. Once a search
+         * has picked its node in the layer below we prefetch it and move on to the next search,
+         * so the loads of the whole batch overlap instead of each waiting for the previous one.
+         */
+        void Search_Batch(const short* const  _types,
+                          const int* const    _values,
+                          const unsigned int  _count,
+                          std::size_t* const  _positions) const
+        {
+            Position node[BATCH_SIZE];
+            int      threshold[BATCH_SIZE];
+            for (unsigned int i = 0; i < _count; i++)
+            {
+                node[i]      = 0;
+                threshold[i] = Batch_Threshold(_types[i], _values[i]);
+            }
+
+            for (std::size_t h = layer_offsets.size() - 1; h > 0; h--)
+            {
+                for (unsigned int i = 0; i < _count; i++)
                 {
-                    std::cerr << "ERROR: Invalid query type.\n";
-                    io.OUT << "ERROR: Invalid query type.\n";
-                    assert(false);
+                    node[i] = node[i] * (NODE_KEYS + 1) + Rank<true>(tree + layer_offsets[h] + node[i] * NODE_KEYS, threshold[i]);
+                    __builtin_prefetch(tree + layer_offsets[h - 1] + node[i] * NODE_KEYS);
                 }
-        }
+            }
+
+            for (unsigned int i = 0; i < _count; i++)
+            {
+                const Position keys_at_most = node[i] * NODE_KEYS + Rank<true>(tree + node[i] * NODE_KEYS, threshold[i]);
+                _positions[i]                  = Batch_Position(_types[i], _values[i], keys_at_most, size);
+            }
+        }
+};
+
+/* Learned_Index: a piecewise linear model of key -> position (PGM / FITing-tree style).
+ * Every segment predicts the position of a key within LEARNED_EPSILON, so a lookup is a search
+ * among the few segment keys (a few KB, always cached) and a search of the 2 * LEARNED_EPSILON + 1
+ * keys around the prediction, instead of log2(n) scattered loads.
+ * Segments are built greedily with a shrinking cone: the slope range that keeps every key
+ * of the segment within LEARNED_EPSILON narrows with every key, and an empty range starts a new segment.
+ * Only the first occurrence of each distinct key is modelled, so the guarantee is for keys in the array;
+ * a value between two keys is checked against the keys bracketing the window, and the rare miss
+ * (long runs of duplicates, floating point rounding) falls back to a search of the whole array.
+ */
+template <class Position>
+class Learned_Index
+{
+    private:
+        static constexpr unsigned int LEARNED_EPSILON = 32;
+        // Below this many keys per segment the model is no smaller than the data it indexes.
+        static constexpr unsigned int MIN_KEYS_PER_SEGMENT = 4 * LEARNED_EPSILON;
+
+        struct Segment
+        {
+            int      first_key;
+            Position first_position; // 0-based
+            double   slope;
+        };
+
+        const Position             size;
+        const int*                 keys;         // the sorted array, 0-based (not owned)
+        std::vector<int>           segment_keys; // first key of each segment, searched to pick a segment
+        std::vector<Segment>       segments;
+
+        // 0-based index of the first key >= _value.
+        Position Lower_Bound(const int _value) const
+        {
+            const std::size_t segment_index = search::upper_bound(segment_keys.data(), segment_keys.size(), _value);
+            if (segment_index == 0)
+            {
+                // Smaller than every key.
+                return 0;
+            }
+
+            const Segment& segment    = segments[segment_index - 1];
+            const double   prediction = static_cast<double>(segment.first_position)
+                                        + segment.slope * static_cast<double>(static_cast<long long>(_value) - segment.first_key);
+            const Position predicted  = static_cast<Position>(std::max(0.0, std::min(prediction, static_cast<double>(size))));
+
+            const Position first = predicted > LEARNED_EPSILON + 1 ? predicted - LEARNED_EPSILON - 1 : 0;
+            const Position last  = std::min<Position>(predicted + LEARNED_EPSILON + 2, size);
+
+            // The window holds the answer only if the key before it is < _value and the key at its end is >= _value.
+            if ((first == 0 || keys[first - 1] < _value) && (last == size || keys[last] >= _value))
+            {
+                return first + static_cast<Position>(search::lower_bound(keys + first, last - first, _value));
+            }
+
+            return static_cast<Position>(search::lower_bound(keys, size, _value));
+        }
+
+    public:
+        // _numbers is 1-based (_numbers[0] is unused), as read by main().
+        Learned_Index(const std::vector<int>& _numbers, const Position _size)
+            : size(_size), keys(_numbers.data() + 1)
+        {
+            double slope_low  = 0;
+            double slope_high = 0;
+            for (Position i = 0; i < size; i++)
+            {
+                if (i > 0 && keys[i] == keys[i - 1])
+                {
+                    continue;
+                }
+
+                if (segments.empty() == false)
+                {
+                    const Segment& segment  = segments.back();
+                    const double   distance = static_cast<double>(static_cast<long long>(keys[i]) - segment.first_key);
+                    const double   rise     = static_cast<double>(i) - static_cast<double>(segment.first_position);
+                    const double   low      = (rise - LEARNED_EPSILON) / distance;
+                    const double   high     = (rise + LEARNED_EPSILON) / distance;
+                    if (std::max(slope_low, low) <= std::min(slope_high, high))
+                    {
+                        slope_low              = std::max(slope_low, low);
+                        slope_high             = std::min(slope_high, high);
+                        segments.back().slope  = (slope_low + slope_high) / 2;
+                        continue;
+                    }
+                }
+
+                // Start a new segment at this key. Any slope fits a single point.
+                segments.push_back({keys[i], i, 0});
+                segment_keys.push_back(keys[i]);
+                slope_low  = 0;
+                slope_high = HUGE_VAL;
+            }
+        }
+
+        std::size_t Segments_Count() const
+        {
+            return segments.size();
+        }
+
+        std::size_t Model_Size() const
+        {
+            return segments.size() * (sizeof(Segment) + sizeof(int));
+        }
+
+        /* Adversarial keys (clusters, exponential gaps) split the model into tiny segments;
+         * it is then no better than searching the keys themselves and the caller should use another index.
+         */
+        bool Is_Effective() const
+        {
+            return segments.size() * MIN_KEYS_PER_SEGMENT <= size;
+        }
+
+        // Same result as binary_search(numbers, _value, 1, size, max_step).
+        Position Last_Less_Or_Equal(const int _value) const
+        {
+            const Position position = _value == INT_MAX ? size : Lower_Bound(_value + 1);
+            return position ? position : 1;
+        }
+
+        // Same result as reverse_binary_search(numbers, _value, 1, size, max_step).
+        Position First_Greater_Or_Equal(const int _value) const
+        {
+            const Position index = Lower_Bound(_value);
+            return index < size ? index + 1 : size;
+        }
+
+        // The model has no dependent loads to overlap, so a batch is answered query by query.
+        void Search_Batch(const short* const  _types,
+                          const int* const    _values,
+                          const unsigned int  _count,
+                          std::size_t* const  _positions) const
+        {
+            for (unsigned int i = 0; i < _count; i++)
+            {
+                // Batch_Threshold is never INT_MAX, so threshold + 1 cannot overflow.
+                const int threshold = Batch_Threshold(_types[i], _values[i]);
+                _positions[i]       = Batch_Position(_types[i], _values[i], Lower_Bound(threshold + 1), size);
+            }
+        }
+};
+
+/* Finger_Index: finger search for query streams with locality.
+ * Each search gallops out from the previous answer, so a nearly sorted stream costs
+ * O(log distance) per query instead of restarting from the middle of the array.
+ * The finger makes lookups stateful: answers depend only on the queries,
+ * but the cost depends on their order.
+ */
+template <class Position>
+class Finger_Index
+{
+    private:
+        const Position   size;
+        const int*       keys;       // the sorted array, 0-based (not owned)
+        mutable Position finger = 0; // 0-based index of the previous answer
+
+    public:
+        // _numbers is 1-based (_numbers[0] is unused), as read by main().
+        Finger_Index(const std::vector<int>& _numbers, const Position _size)
+            : size(_size), keys(_numbers.data() + 1)
+        {
+        }
+
+        // Same result as binary_search(numbers, _value, 1, size, max_step).
+        Position Last_Less_Or_Equal(const int _value) const
+        {
+            finger = static_cast<Position>(search::gallop_upper_bound(keys, size, _value, finger));
+            return finger ? finger : 1;
+        }
+
+        // Same result as reverse_binary_search(numbers, _value, 1, size, max_step).
+        Position First_Greater_Or_Equal(const int _value) const
+        {
+            finger = static_cast<Position>(search::gallop_lower_bound(keys, size, _value, finger));
+            return finger < size ? finger + 1 : size;
+        }
+
+        // Each search starts where the previous one ended, so a batch is answered in order.
+        void Search_Batch(const short* const  _types,
+                          const int* const    _values,
+                          const unsigned int  _count,
+                          std::size_t* const  _positions) const
+        {
+            for (unsigned int i = 0; i < _count; i++)
+            {
+                finger        = static_cast<Position>(search::gallop_upper_bound(keys, size, Batch_Threshold(_types[i], _values[i]), finger));
+                _positions[i] = Batch_Position(_types[i], _values[i], finger, size);
+            }
+        }
+};
+
+/* Sorted_Array_Index: cautbin's 1-based query semantics straight on top of the search functions.
+ * It needs no memory beyond the keys, so it serves a mapped array that has no index section.
+ */
+template <class Position>
+class Sorted_Array_Index
+{
+    private:
+        const Position size;
+        const int*     keys; // the sorted array, 0-based (not owned)
+
+    public:
+        Sorted_Array_Index(const int* const _keys, const Position _size)
+            : size(_size), keys(_keys)
+        {
+        }
+
+        // Same result as binary_search(numbers, _value, 1, size, max_step).
+        Position Last_Less_Or_Equal(const int _value) const
+        {
+            const std::size_t index = search::last_less_or_equal(keys, size, _value);
+            return index == search::NOT_FOUND ? 1 : static_cast<Position>(index + 1);
+        }
+
+        // Same result as reverse_binary_search(numbers, _value, 1, size, max_step).
+        Position First_Greater_Or_Equal(const int _value) const
+        {
+            const std::size_t index = search::first_greater_or_equal(keys, size, _value);
+            return index == search::NOT_FOUND ? size : static_cast<Position>(index + 1);
+        }
+
+        // Each search is a branchless loop over the keys, so a batch is answered query by query.
+        void Search_Batch(const short* const  _types,
+                          const int* const    _values,
+                          const unsigned int  _count,
+                          std::size_t* const  _positions) const
+        {
+            for (unsigned int i = 0; i < _count; i++)
+            {
+                const std::size_t keys_at_most = search::upper_bound(keys, size, Batch_Threshold(_types[i], _values[i]));
+                _positions[i]                  = Batch_Position(_types[i], _values[i], keys_at_most, size);
+            }
+        }
+};
+
+// keys is the sorted array, 0-based; position is 1-based.
+void Write_Answer(IO& io, const int* const keys, const short query_type, const int query_value, const std::size_t position)
+{
+    switch (query_type)
+    {
+        case 0:
+            {
+                // Find the first occurrence of query_value in the array.
+                // If it exists, return the position of the last occurrence.
+                // If it doesn't exist, return -1.
+                if (keys[position - 1] != query_value)
+                {
+                    io.OUT << "-1\n";
+                }
+                else
+                {
+                    io.OUT << position << '\n';
+                }
+                break;
+            }
+        case 1:
+            {
+                // Find the last number smaller or equal than query_value.
+                io.OUT << position << '\n';
+                break;
+            }
+        case 2:
+            {
+                // Find the first number greater or equal than query_value.
+                io.OUT << position << '\n';
+                break;
+            }
+        default:
+            {
+                std::cerr << "ERROR: Invalid query type.\n";
+                io.OUT << "ERROR: Invalid query type.\n";
+                assert(false);
+            }
+    }
+}
+
+template <class Index>
+void Answer_Queries(IO& io, const int* const keys, const Index& index, unsigned int queries_count)
+{
+    short       query_types[BATCH_SIZE];  // 0 ≤ query_type ≤ 2
+    int         query_values[BATCH_SIZE]; // INT_MIN ≤ query_value ≤ INT_MAX
+    std::size_t positions[BATCH_SIZE];
+
+    while (queries_count)
+    {
+        const unsigned int batch_size = std::min(queries_count, BATCH_SIZE);
+        for (unsigned int i = 0; i < batch_size; i++)
+        {
+            io.IN >> query_types[i] >> query_values[i];
+        }
+
+        index.Search_Batch(query_types, query_values, batch_size, positions);
+
+        // Answers are written in input order.
+        for (unsigned int i = 0; i < batch_size; i++)
+        {
+            Write_Answer(io, keys, query_types[i], query_values[i], positions[i]);
+        }
+
+        queries_count -= batch_size;
+    }
+}
+
+/* LSD radix sort on the upper 32 bits of _items, one byte per pass.
+ * The lower 32 bits ride along (we keep the query index there).
+ */
+void Radix_Sort_By_High_Word(std::vector<std::uint64_t>& _items)
+{
+    std::vector<std::uint64_t> buffer(_items.size());
+    for (unsigned int shift = 32; shift < 64; shift += 8)
+    {
+        std::size_t buckets[257] = {};
+        for (const std::uint64_t item : _items)
+        {
+            buckets[((item >> shift) & 0xFF) + 1]++;
+        }
+
+        for (unsigned int digit = 0; digit < 256; digit++)
+        {
+            buckets[digit + 1] += buckets[digit];
+        }
+
+        for (const std::uint64_t item : _items)
+        {
+            buffer[buckets[(item >> shift) & 0xFF]++] = item;
+        }
+
+        _items.swap(buffer);
+    }
+}
+
+/* Offline mode: reads every query, sorts them by threshold (see Batch_Threshold)
+ * and answers all of them in a single pass over the array, since the number of keys
+ * <= threshold only grows as the threshold does: each search gallops on from the previous answer.
+ * Answers are then written in input order.
+ */
+void Answer_Queries_Offline(IO& io, const std::vector<int>& numbers, const unsigned int array_size, const unsigned int queries_count)
+{
+    std::vector<short>         query_types(queries_count);
+    std::vector<int>           query_values(queries_count);
+    std::vector<std::uint64_t> sorted_queries(queries_count); // threshold (order-preserving unsigned) << 32 | query index
+    for (unsigned int i = 0; i < queries_count; i++)
+    {
+        io.IN >> query_types[i] >> query_values[i];
+
+        // Flipping the sign bit maps INT_MIN .. INT_MAX onto 0 .. UINT_MAX in the same order.
+        const std::uint32_t threshold = static_cast<std::uint32_t>(Batch_Threshold(query_types[i], query_values[i])) ^ 0x80000000u;
+        sorted_queries[i]             = static_cast<std::uint64_t>(threshold) << 32 | i;
+    }
+
+    Radix_Sort_By_High_Word(sorted_queries);
+
+    std::vector<std::size_t>  positions(queries_count);
+    std::size_t               keys_at_most = 0;
+    for (const std::uint64_t query : sorted_queries)
+    {
+        const unsigned int query_index = static_cast<unsigned int>(query & 0xFFFFFFFFu);
+        const int          threshold   = static_cast<int>(static_cast<std::uint32_t>(query >> 32) ^ 0x80000000u);
+        keys_at_most                   = search::gallop_upper_bound(numbers.data() + 1, array_size, threshold, keys_at_most);
+
+        positions[query_index] = Batch_Position(query_types[query_index], query_values[query_index], keys_at_most, array_size);
+    }
+
+    for (unsigned int i = 0; i < queries_count; i++)
+    {
+        Write_Answer(io, numbers.data() + 1, query_types[i], query_values[i], positions[i]);
+    }
+}
+
+/* cautbin.bin: the sorted array in binary, ready to be searched where it is mapped.
+ *   Sorted_Array_Header   64 bytes
+ *   keys                  key_count little-endian int32, sorted
+ * With HAS_S_TREE_INDEX the keys are padded with INT_MAX to whole 16-key nodes and followed
+ * by the S-tree layers above them (S_Tree_Index::Build_Layers): data_ints ints after the header.
+ * The header is one cache line and mappings are page aligned, so the tree is cache line aligned.
+ */
+constexpr char          SORTED_ARRAY_MAGIC[8] = "CAUTBIN";
+constexpr std::uint32_t SORTED_ARRAY_VERSION  = 1;
+constexpr std::uint32_t HAS_S_TREE_INDEX      = 1;
+constexpr std::uint32_t BYTE_ORDER_MARK       = 0x01020304; // reads back as written only on a little-endian machine
+
+struct Sorted_Array_Header
+{
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t flags;
+    std::uint32_t reserved_flags;
+    std::uint64_t key_count;
+    std::uint64_t data_ints;
+    char          reserved[24];
+};
+
+static_assert(sizeof(Sorted_Array_Header) == 64, "The header must fill exactly one cache line.");
+
+bool Is_Little_Endian()
+{
+    const std::uint32_t one = 1;
+    char                first_byte;
+    std::memcpy(&first_byte, &one, 1);
+    return first_byte == 1;
+}
+
+/* Mapped_File: a read-only view of a whole file.
+ * With mmap the file is never read up front: pages come from the page cache as the searches
+ * touch them, so startup is O(1) and files larger than RAM can be searched.
+ * Elsewhere the file is read into a cache line aligned buffer instead.
+ */
+class Mapped_File
+{
+    private:
+        const char* data = nullptr;
+        std::size_t size = 0;
+        #ifndef HAS_MMAP
+        std::vector<char> buffer;
+        #endif
+
+        void PrintError(const char* const _file_name, const std::string& _error_source) const
+        {
+            std::cerr << _error_source << " file: " << _file_name << "\n"
+                    << "ERROR: " << strerror(errno) << std::endl;
+        }
+
+    public:
+        explicit Mapped_File(const char* const _file_name)
+        {
+            #ifdef HAS_MMAP
+            const int file_descriptor = open(_file_name, O_RDONLY);
+            if (file_descriptor < 0)
+            {
+                PrintError(_file_name, "Failed to open sorted array");
+                assert(false);
+                return;
+            }
+
+            struct stat file_status;
+            if (fstat(file_descriptor, &file_status) == 0 && file_status.st_size > 0)
+            {
+                size = static_cast<std::size_t>(file_status.st_size);
+                void* const mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, file_descriptor, 0);
+                if (mapping == MAP_FAILED)
+                {
+                    PrintError(_file_name, "Failed to map sorted array");
+                    size = 0;
+                    assert(false);
+                }
+                else
+                {
+                    // Searches jump around the file: read-ahead would only evict useful pages.
+                    madvise(mapping, size, MADV_RANDOM);
+                    data = static_cast<const char*>(mapping);
+                }
+            }
+
+            close(file_descriptor);
+            #else
+            std::ifstream file(_file_name, std::ios::binary | std::ios::ate);
+            if (!file.is_open())
+            {
+                PrintError(_file_name, "Failed to open sorted array");
+                assert(false);
+                return;
+            }
+
+            size = static_cast<std::size_t>(file.tellg());
+            buffer.resize(size + 64);
+            const std::size_t misalignment = reinterpret_cast<std::uintptr_t>(buffer.data()) % 64;
+            char* const       aligned_data = buffer.data() + (misalignment ? 64 - misalignment : 0);
+            file.seekg(0);
+            file.read(aligned_data, static_cast<std::streamsize>(size));
+            data = aligned_data;
+            #endif
+        }
+
+        ~Mapped_File()
+        {
+            #ifdef HAS_MMAP
+            if (data)
+            {
+                munmap(const_cast<char*>(data), size);
+            }
+            #endif
+        }
+
+        Mapped_File(const Mapped_File&)            = delete;
+        Mapped_File& operator=(const Mapped_File&) = delete;
+
+        const char* Data() const
+        {
+            return data;
+        }
+
+        std::size_t Size() const
+        {
+            return size;
+        }
+};
+
+// -DCONVERT_INPUT: splits cautbin.in into cautbin.bin (array + S-tree index) and cautbin.queries.
+void Convert_Input()
+{
+    if (Is_Little_Endian() == false)
+    {
+        std::cerr << "ERROR: cautbin.bin stores little-endian keys; big-endian machines are not supported.\n";
+        assert(false);
+    }
+
+    IO& io = IO::GetInstance(INPUT_FILE_NAME, QUERIES_FILE_NAME);
+
+    unsigned int array_size;
+    io.IN >> array_size;
+
+    std::vector<int> tree(S_Tree_Index<std::uint64_t>::Tree_Keys(array_size));
+    for (unsigned int i = 0; i < array_size; i++)
+    {
+        io.IN >> tree[i];
+    }
+    S_Tree_Index<std::uint64_t>::Build_Layers(tree.data(), array_size);
+
+    Sorted_Array_Header header = {};
+    std::memcpy(header.magic, SORTED_ARRAY_MAGIC, sizeof(header.magic));
+    header.version    = SORTED_ARRAY_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.flags      = HAS_S_TREE_INDEX;
+    header.key_count  = array_size;
+    header.data_ints  = tree.size();
+
+    std::ofstream file(SORTED_ARRAY_FILE_NAME, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open output file: " << SORTED_ARRAY_FILE_NAME << "\n"
+                << "ERROR: " << strerror(errno) << std::endl;
+        assert(false);
+        return;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(tree.data()), static_cast<std::streamsize>(tree.size() * sizeof(int)));
+
+    // Whatever is left of cautbin.in is the query section.
+    io.OUT << io.IN.rdbuf();
+}
+
+// Answers the queries against the _key_count mapped _keys, with Position-wide indexes.
+template <class Position>
+void Search_Mapped_Keys(IO& io, const Sorted_Array_Header& _header, const int* const _keys, const unsigned int _queries_count)
+{
+    const Position key_count = static_cast<Position>(_header.key_count);
+    if ((_header.flags & HAS_S_TREE_INDEX) && _header.data_ints == S_Tree_Index<Position>::Tree_Keys(key_count))
+    {
+        Answer_Queries(io, _keys, S_Tree_Index<Position>::From_Tree(_keys, key_count), _queries_count);
+    }
+    else
+    {
+        // No index section: search the mapped keys as they are, rather than copy them into an S-tree.
+        Answer_Queries(io, _keys, Sorted_Array_Index<Position>(_keys, key_count), _queries_count);
+    }
+}
+
+// -DMAPPED_INPUT: answers cautbin.queries against cautbin.bin, searching the mapped file in place.
+void Answer_Mapped_Queries()
+{
+    IO&               io = IO::GetInstance(QUERIES_FILE_NAME, OUTPUT_FILE_NAME);
+    const Mapped_File file(SORTED_ARRAY_FILE_NAME);
+
+    Sorted_Array_Header header = {};
+    if (file.Size() >= sizeof(header))
+    {
+        std::memcpy(&header, file.Data(), sizeof(header));
+    }
+
+    if (std::memcmp(header.magic, SORTED_ARRAY_MAGIC, sizeof(header.magic)) != 0
+        || header.version != SORTED_ARRAY_VERSION
+        || header.byte_order != BYTE_ORDER_MARK
+        || header.key_count == 0
+        || header.data_ints < header.key_count
+        || (file.Size() - sizeof(header)) / sizeof(int) < header.data_ints)
+    {
+        std::cerr << "ERROR: " << SORTED_ARRAY_FILE_NAME << " is not a valid sorted array file.\n";
+        assert(false);
+        return;
+    }
+
+    const int* const keys = reinterpret_cast<const int*>(file.Data() + sizeof(header));
+
+    unsigned int queries_count;
+    io.IN >> queries_count;
+
+    // 32-bit positions whenever every int of the file can be addressed with them.
+    if (header.data_ints <= UINT32_MAX)
+    {
+        Search_Mapped_Keys<std::uint32_t>(io, header, keys, queries_count);
+    }
+    else
+    {
+        Search_Mapped_Keys<std::uint64_t>(io, header, keys, queries_count);
+    }
+}
+
+#ifdef BENCHMARK
+/* Times one million type 1 and type 2 queries against _index
+ * and returns a checksum of the answers (which also keeps the loop from being optimised away).
+ */
+template <class Index>
+unsigned long long Benchmark_Queries(const char* const       _name,
+                                     const std::string&      _label,
+                                     const Index&            _index,
+                                     const std::vector<int>& _queries)
+{
+    unsigned long long checksum = 0;
+    Profiling          profiling(_name, _label.c_str());
+    for (const int query : _queries)
+    {
+        checksum += _index.Last_Less_Or_Equal(query);
+        checksum += _index.First_Greater_Or_Equal(query);
+    }
+    profiling.End_Profiling();
+
+    return checksum;
+}
+
+// Same as Benchmark_Queries, through Search_Batch. _types and _values hold a type 1 and a type 2 query per value.
+template <class Index>
+unsigned long long Benchmark_Batches(const char* const         _name,
+                                     const std::string&        _label,
+                                     const Index&              _index,
+                                     const std::vector<short>& _types,
+                                     const std::vector<int>&   _values)
+{
+    unsigned long long checksum = 0;
+    std::size_t        positions[BATCH_SIZE];
+    Profiling          profiling(_name, _label.c_str());
+    for (std::size_t first = 0; first < _values.size(); first += BATCH_SIZE)
+    {
+        const unsigned int batch_size = static_cast<unsigned int>(std::min<std::size_t>(BATCH_SIZE, _values.size() - first));
+        _index.Search_Batch(_types.data() + first, _values.data() + first, batch_size, positions);
+        for (unsigned int i = 0; i < batch_size; i++)
+        {
+            checksum += positions[i];
+        }
+    }
+    profiling.End_Profiling();
+
+    return checksum;
+}
+
+// Reports the Learned_Index model on _numbers and, if the model is worth using, its query latency.
+void Benchmark_Learned_Index(const std::string&      _label,
+                             const std::vector<int>& _numbers,
+                             const unsigned int      _size,
+                             const std::vector<int>& _queries,
+                             const unsigned long long _checksum)
+{
+    Profiling           profiling_build("Learned_Index (build)", _label.c_str());
+    const Learned_Index<std::uint32_t> index(_numbers, _size);
+    profiling_build.End_Profiling();
+
+    std::cout << "Learned_Index : " << index.Segments_Count() << " segments, "
+            << index.Model_Size() << " bytes, " << (index.Is_Effective() ? "effective" : "falls back to S_Tree_Index") << "\n"
+            << "             " << _label << "\n";
+
+    const unsigned long long index_checksum = Benchmark_Queries("Learned_Index", _label, index, _queries);
+    assert(index_checksum == _checksum);
+    (void)index_checksum;
+}
+
+/* Compares the step loop, the S-tree and finger search on a random sorted array
+ * of 10^7 elements for three query streams: random, sorted and clustered
+ * (bursts of 64 queries within 10^5 of a random centre).
+ */
+void Benchmark_Query_Streams(std::mt19937& _generator)
+{
+    constexpr unsigned int ARRAY_SIZE        = 10'000'000;
+    constexpr unsigned int BENCHMARK_QUERIES = 1'000'000;
+    constexpr unsigned int CLUSTER_SIZE      = 64;
+    constexpr int          CLUSTER_RADIUS    = 100'000;
+
+    std::uniform_int_distribution<int> distribution(-1'000'000'000, 1'000'000'000);
+    std::uniform_int_distribution<int> offset_distribution(-CLUSTER_RADIUS, CLUSTER_RADIUS);
+
+    std::vector<int> numbers(ARRAY_SIZE + 1);
+    for (unsigned int i = 1; i <= ARRAY_SIZE; i++)
+    {
+        numbers[i] = distribution(_generator);
     }
+    std::sort(numbers.begin() + 1, numbers.end());
+
+    std::vector<int> random_queries(BENCHMARK_QUERIES);
+    std::vector<int> clustered_queries(BENCHMARK_QUERIES);
+    for (unsigned int i = 0; i < BENCHMARK_QUERIES; i++)
+    {
+        random_queries[i] = distribution(_generator);
+        clustered_queries[i] = i % CLUSTER_SIZE ? clustered_queries[i - i % CLUSTER_SIZE] + offset_distribution(_generator)
+                                                : distribution(_generator);
+    }
+    std::vector<int> sorted_queries = random_queries;
+    std::sort(sorted_queries.begin(), sorted_queries.end());
+
+    const unsigned int                                         max_step = bit_floor(ARRAY_SIZE);
+    const std::pair<const char*, const std::vector<int>*> streams[] = {
+        {"random", &random_queries},
+        {"sorted", &sorted_queries},
+        {"clustered", &clustered_queries}
+    };
+
+    for (const auto& stream : streams)
+    {
+        const std::string       label   = "n = " + std::to_string(ARRAY_SIZE) + ", " + stream.first + " queries";
+        const std::vector<int>& queries = *stream.second;
+
+        unsigned long long checksum = 0;
+        Profiling          profiling_steps("binary_search", label.c_str());
+        for (const int query : queries)
+        {
+            checksum += binary_search(numbers.data(), query, 1u, ARRAY_SIZE, max_step);
+            checksum += reverse_binary_search(numbers.data(), query, 1u, ARRAY_SIZE, max_step);
+        }
+        profiling_steps.End_Profiling();
+
+        const unsigned long long s_tree_checksum = Benchmark_Queries("S_Tree_Index", label, S_Tree_Index<std::uint32_t>(numbers, ARRAY_SIZE), queries);
+        const unsigned long long finger_checksum = Benchmark_Queries("Finger_Index", label, Finger_Index<std::uint32_t>(numbers, ARRAY_SIZE), queries);
+        assert(s_tree_checksum == checksum && finger_checksum == checksum);
+        (void)s_tree_checksum;
+        (void)finger_checksum;
+    }
+}
+
+/* Compares the step loop against the search indexes on random sorted arrays
+ * of 10^3 .. 10^8 elements. The checksums guarantee all of them answer identically.
+ * The learned index is also run on clustered keys with random gaps, which defeat its linear model.
+ */
+void Benchmark()
+{
+    constexpr unsigned int BENCHMARK_QUERIES = 1'000'000;
+
+    std::mt19937                       generator(2024);
+    std::uniform_int_distribution<int> distribution(-1'000'000'000, 1'000'000'000);
+
+    std::vector<int>   queries(BENCHMARK_QUERIES);
+    std::vector<short> batch_types;
+    std::vector<int>   batch_values;
+    for (int& query : queries)
+    {
+        query = distribution(generator);
+        batch_types.push_back(1);
+        batch_values.push_back(query);
+        batch_types.push_back(2);
+        batch_values.push_back(query);
+    }
+
+    for (unsigned int array_size = 1'000; array_size <= 100'000'000; array_size *= 10)
+    {
+        std::vector<int> numbers(array_size + 1);
+        for (unsigned int i = 1; i <= array_size; i++)
+        {
+            numbers[i] = distribution(generator);
+        }
+        std::sort(numbers.begin() + 1, numbers.end());
+
+        const unsigned int max_step = bit_floor(array_size);
+        const std::string  label    = "n = " + std::to_string(array_size);
+
+        unsigned long long checksum = 0;
+        Profiling          profiling_steps("binary_search", label.c_str());
+        for (const int query : queries)
+        {
+            checksum += binary_search(numbers.data(), query, 1u, array_size, max_step);
+            checksum += reverse_binary_search(numbers.data(), query, 1u, array_size, max_step);
+        }
+        profiling_steps.End_Profiling();
+
+        {
+            Profiling                            profiling_build("Eytzinger_Index (build)", label.c_str());
+            const Eytzinger_Index<std::uint32_t> index(numbers, array_size);
+            profiling_build.End_Profiling();
+            const unsigned long long index_checksum = Benchmark_Queries("Eytzinger_Index", label, index, queries);
+            const unsigned long long batch_checksum = Benchmark_Batches("Eytzinger_Index (batched)", label, index, batch_types, batch_values);
+            assert(index_checksum == checksum && batch_checksum == checksum);
+            (void)index_checksum;
+            (void)batch_checksum;
+        }
+
+        {
+            Profiling                         profiling_build("S_Tree_Index (build)", label.c_str());
+            const S_Tree_Index<std::uint32_t> index(numbers, array_size);
+            profiling_build.End_Profiling();
+            const unsigned long long index_checksum = Benchmark_Queries("S_Tree_Index", label, index, queries);
+            const unsigned long long batch_checksum = Benchmark_Batches("S_Tree_Index (batched)", label, index, batch_types, batch_values);
+            assert(index_checksum == checksum && batch_checksum == checksum);
+            (void)index_checksum;
+            (void)batch_checksum;
+        }
+
+        Benchmark_Learned_Index(label, numbers, array_size, queries, checksum);
+    }
+
+    for (unsigned int array_size = 1'000'000; array_size <= 10'000'000; array_size *= 10)
+    {
+        // Runs of 1 .. 64 consecutive keys separated by random gaps, about 2 * 10^9 wide in total.
+        std::uniform_int_distribution<int> run_distribution(1, 64);
+        std::uniform_int_distribution<int> gap_distribution(1, static_cast<int>(128'000'000'000ull / array_size));
+
+        std::vector<int> numbers(array_size + 1);
+        int              key = -1'000'000'000;
+        for (unsigned int i = 1; i <= array_size;)
+        {
+            key += gap_distribution(generator);
+            for (int run = run_distribution(generator); run > 0 && i <= array_size; run--, i++)
+            {
+                numbers[i] = key++;
+            }
+        }
+
+        const unsigned int max_step = bit_floor(array_size);
+        const std::string  label    = "n = " + std::to_string(array_size) + " (clustered)";
+
+        unsigned long long checksum = 0;
+        Profiling          profiling_steps("binary_search", label.c_str());
+        for (const int query : queries)
+        {
+            checksum += binary_search(numbers.data(), query, 1u, array_size, max_step);
+            checksum += reverse_binary_search(numbers.data(), query, 1u, array_size, max_step);
+        }
+        profiling_steps.End_Profiling();
+
+        Benchmark_Learned_Index(label, numbers, array_size, queries, checksum);
+    }
+
+    Benchmark_Query_Streams(generator);
+}
+#endif
+
+#ifdef VERIFY
+/* Checks every search function, and search::Eytzinger, against std::lower_bound and std::upper_bound
+ * on VERIFY_TRIALS random sorted ranges of Key. _make_key draws keys from a narrow set, so the ranges
+ * are full of duplicates and most queries hit a key. Returns the number of mismatches.
+ */
+template <class Key, class Make_Key>
+unsigned int Verify_Search(const char* const _key_name, std::mt19937& _generator, Make_Key _make_key)
+{
+    constexpr unsigned int VERIFY_TRIALS = 300;
+    constexpr unsigned int MAX_SIZE      = 300;
+    constexpr unsigned int QUERIES       = 100;
+
+    std::uniform_int_distribution<unsigned int> size_distribution(0, MAX_SIZE);
+
+    unsigned int mismatches = 0;
+    for (unsigned int trial = 0; trial < VERIFY_TRIALS; trial++)
+    {
+        std::vector<Key> keys(size_distribution(_generator));
+        for (Key& key : keys)
+        {
+            key = _make_key(_generator);
+        }
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<Key> values(QUERIES);
+        for (Key& value : values)
+        {
+            value = _make_key(_generator);
+        }
+
+        const std::size_t            size = keys.size();
+        const search::Eytzinger<Key> eytzinger(keys.data(), size);
+        std::vector<std::size_t>     batch_indexes(QUERIES);
+        eytzinger.Upper_Bound_Batch(values.data(), QUERIES, batch_indexes.data());
+
+        std::uniform_int_distribution<std::size_t> hint_distribution(0, size + 1);
+        for (unsigned int query = 0; query < QUERIES; query++)
+        {
+            const Key&        value = values[query];
+            const std::size_t lower = static_cast<std::size_t>(std::lower_bound(keys.begin(), keys.end(), value) - keys.begin());
+            const std::size_t upper = static_cast<std::size_t>(std::upper_bound(keys.begin(), keys.end(), value) - keys.begin());
+            const std::size_t hint  = hint_distribution(_generator);
+
+            const std::pair<std::size_t, std::size_t> range      = search::equal_range(keys.data(), size, value);
+            const std::pair<std::size_t, std::size_t> tree_range = eytzinger.Equal_Range(value);
+
+            const std::pair<const char*, bool> checks[] = {
+                {"lower_bound", search::lower_bound(keys.data(), size, value) == lower},
+                {"upper_bound", search::upper_bound(keys.data(), size, value) == upper},
+                {"equal_range", range.first == lower && range.second == upper},
+                {"last_less_or_equal", search::last_less_or_equal(keys.data(), size, value) == (upper ? upper - 1 : search::NOT_FOUND)},
+                {"first_greater_or_equal", search::first_greater_or_equal(keys.data(), size, value) == (lower < size ? lower : search::NOT_FOUND)},
+                {"gallop_lower_bound", search::gallop_lower_bound(keys.data(), size, value, hint) == lower},
+                {"gallop_upper_bound", search::gallop_upper_bound(keys.data(), size, value, hint) == upper},
+                {"Eytzinger::Lower_Bound", eytzinger.Lower_Bound(value) == lower},
+                {"Eytzinger::Upper_Bound", eytzinger.Upper_Bound(value) == upper},
+                {"Eytzinger::Equal_Range", tree_range.first == lower && tree_range.second == upper},
+                {"Eytzinger::Last_Less_Or_Equal", eytzinger.Last_Less_Or_Equal(value) == (upper ? upper - 1 : search::NOT_FOUND)},
+                {"Eytzinger::First_Greater_Or_Equal", eytzinger.First_Greater_Or_Equal(value) == (lower < size ? lower : search::NOT_FOUND)},
+                {"Eytzinger::Upper_Bound_Batch", batch_indexes[query] == upper}
+            };
+
+            for (const std::pair<const char*, bool>& check : checks)
+            {
+                if (check.second == false)
+                {
+                    std::cerr << "Mismatch in " << check.first << " for " << _key_name << " keys (trial " << trial
+                            << ", size " << size << ", query " << query << ")\n";
+                    mismatches++;
+                }
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+/* Checks the answers of one index (a Last_Less_Or_Equal, a First_Greater_Or_Equal and a Search_Batch per query)
+ * against the step search. Returns the number of mismatches.
+ */
+template <class Index>
+unsigned int Verify_Index(const char* const               _index_name,
+                          const Index&                    _index,
+                          const std::vector<short>&       _types,
+                          const std::vector<int>&         _values,
+                          const std::vector<std::size_t>& _last_less_or_equal,
+                          const std::vector<std::size_t>& _first_greater_or_equal)
+{
+    unsigned int mismatches = 0;
+    std::size_t  positions[BATCH_SIZE];
+    for (std::size_t first = 0; first < _values.size(); first += BATCH_SIZE)
+    {
+        const unsigned int batch_size = static_cast<unsigned int>(std::min<std::size_t>(BATCH_SIZE, _values.size() - first));
+        _index.Search_Batch(_types.data() + first, _values.data() + first, batch_size, positions);
+
+        for (unsigned int i = 0; i < batch_size; i++)
+        {
+            const std::size_t query    = first + i;
+            const std::size_t expected = _types[query] == 2 ? _first_greater_or_equal[query] : _last_less_or_equal[query];
+            if (_index.Last_Less_Or_Equal(_values[query]) != _last_less_or_equal[query]
+                || _index.First_Greater_Or_Equal(_values[query]) != _first_greater_or_equal[query]
+                || positions[i] != expected)
+            {
+                std::cerr << "Mismatch in " << _index_name << " for query " << query << " (" << _types[query] << ' '
+                        << _values[query] << ")\n";
+                mismatches++;
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+/* Checks that every index answers the same with 32-bit and 64-bit positions,
+ * and the same as binary_search and reverse_binary_search with either width.
+ * Returns the number of mismatches.
+ */
+unsigned int Verify_Index_Widths(std::mt19937& _generator)
+{
+    constexpr unsigned int VERIFY_TRIALS = 100;
+    constexpr unsigned int MAX_SIZE      = 5'000;
+    constexpr unsigned int QUERIES       = 1'000;
+
+    std::uniform_int_distribution<unsigned int> size_distribution(1, MAX_SIZE);
+    std::uniform_int_distribution<int>          range_distribution(0, 2);
+    std::uniform_int_distribution<short>        type_distribution(0, 2);
+
+    unsigned int mismatches = 0;
+    for (unsigned int trial = 0; trial < VERIFY_TRIALS; trial++)
+    {
+        // Narrow ranges are full of duplicates; the full range reaches INT_MIN and INT_MAX.
+        const int                          range = range_distribution(_generator);
+        std::uniform_int_distribution<int> key_distribution(range == 0 ? -10 : range == 1 ? 0 : INT_MIN,
+                                                            range == 0 ? 10 : range == 1 ? 1'000'000 : INT_MAX);
+
+        const unsigned int size = size_distribution(_generator);
+        std::vector<int>   numbers(size + 1); // 1-based, as read by main()
+        for (unsigned int i = 1; i <= size; i++)
+        {
+            numbers[i] = key_distribution(_generator);
+        }
+        std::sort(numbers.begin() + 1, numbers.end());
+
+        std::vector<short>       types(QUERIES);
+        std::vector<int>         values(QUERIES);
+        std::vector<std::size_t> last_less_or_equal(QUERIES);
+        std::vector<std::size_t> first_greater_or_equal(QUERIES);
+        for (unsigned int query = 0; query < QUERIES; query++)
+        {
+            types[query]  = type_distribution(_generator);
+            values[query] = query % 4 ? key_distribution(_generator) : query % 8 ? INT_MIN : INT_MAX;
+
+            const std::uint32_t last_32  = binary_search<std::uint32_t>(numbers.data(), values[query], 1, size, bit_floor(std::uint32_t{size}));
+            const std::uint64_t last_64  = binary_search<std::uint64_t>(numbers.data(), values[query], 1, size, bit_floor(std::uint64_t{size}));
+            const std::uint32_t first_32 = reverse_binary_search<std::uint32_t>(numbers.data(), values[query], 1, size, bit_floor(std::uint32_t{size}));
+            const std::uint64_t first_64 = reverse_binary_search<std::uint64_t>(numbers.data(), values[query], 1, size, bit_floor(std::uint64_t{size}));
+            if (last_32 != last_64 || first_32 != first_64)
+            {
+                std::cerr << "Mismatch between the 32-bit and 64-bit step searches for " << values[query] << "\n";
+                mismatches++;
+            }
+
+            last_less_or_equal[query]     = last_64;
+            first_greater_or_equal[query] = first_64;
+        }
+
+        const auto verify = [&](const char* const _index_name, const auto& _index) {
+            return Verify_Index(_index_name, _index, types, values, last_less_or_equal, first_greater_or_equal);
+        };
+
+        const int* const keys = numbers.data() + 1;
+        mismatches += verify("Eytzinger_Index<uint32_t>", Eytzinger_Index<std::uint32_t>(numbers, size));
+        mismatches += verify("Eytzinger_Index<uint64_t>", Eytzinger_Index<std::uint64_t>(numbers, size));
+        mismatches += verify("S_Tree_Index<uint32_t>", S_Tree_Index<std::uint32_t>(numbers, size));
+        mismatches += verify("S_Tree_Index<uint64_t>", S_Tree_Index<std::uint64_t>(numbers, size));
+        mismatches += verify("Learned_Index<uint32_t>", Learned_Index<std::uint32_t>(numbers, size));
+        mismatches += verify("Learned_Index<uint64_t>", Learned_Index<std::uint64_t>(numbers, size));
+        mismatches += verify("Finger_Index<uint32_t>", Finger_Index<std::uint32_t>(numbers, size));
+        mismatches += verify("Finger_Index<uint64_t>", Finger_Index<std::uint64_t>(numbers, size));
+        mismatches += verify("Sorted_Array_Index<uint32_t>", Sorted_Array_Index<std::uint32_t>(keys, size));
+        mismatches += verify("Sorted_Array_Index<uint64_t>", Sorted_Array_Index<std::uint64_t>(keys, size));
+    }
+
+    return mismatches;
+}
+
+/* Checks the search namespace for every key type it is meant for (see the comment above it),
+ * then every index of cautbin with both index widths.
+ */
+void Verify()
+{
+    constexpr int KEY_RANGE = 50;
+
+    std::mt19937                       generator(2024);
+    std::uniform_int_distribution<int> distribution(-KEY_RANGE, KEY_RANGE);
+
+    unsigned int mismatches = 0;
+
+    // The extremes of the type are keys like any other.
+    mismatches += Verify_Search<std::int32_t>("int32_t", generator, [&](std::mt19937& _generator) {
+        const int key = distribution(_generator);
+        return key == -KEY_RANGE ? INT32_MIN : key == KEY_RANGE ? INT32_MAX : key;
+    });
+
+    mismatches += Verify_Search<std::int64_t>("int64_t", generator, [&](std::mt19937& _generator) {
+        return static_cast<std::int64_t>(distribution(_generator)) * (std::int64_t{1} << 40);
+    });
+
+    mismatches += Verify_Search<std::uint64_t>("uint64_t", generator, [&](std::mt19937& _generator) {
+        return static_cast<std::uint64_t>(distribution(_generator) + KEY_RANGE) * (UINT64_MAX / (2 * KEY_RANGE));
+    });
+
+    mismatches += Verify_Search<float>("float", generator, [&](std::mt19937& _generator) {
+        return static_cast<float>(distribution(_generator)) / 4;
+    });
+
+    // Four letters out of "abc": a memcmp key, searched with branches.
+    using String_Key = search::Fixed_String<4>;
+    mismatches += Verify_Search<String_Key>("Fixed_String<4>", generator, [&](std::mt19937& _generator) {
+        String_Key key;
+        for (char& character : key.chars)
+        {
+            character = static_cast<char>('a' + (distribution(_generator) + KEY_RANGE) % 3);
+        }
+        return key;
+    });
+
+    mismatches += Verify_Index_Widths(generator);
+
+    std::cout << "Verify: " << mismatches << " mismatches\n";
+    assert(mismatches == 0);
+}
+#endif
+
+// Default mode: answers cautbin.in, array and queries both in text.
+void Answer_Input()
+{
+    IO& io = IO::GetInstance(INPUT_FILE_NAME, OUTPUT_FILE_NAME);
+
+    unsigned int array_size;
+    io.IN >> array_size; // 1 ≤ array_size ≤ 100 000
+
+    std::vector<int> numbers(array_size + 1); // INT_MIN ≤ numbers[i] ≤ INT_MAX; numbers[i] <= numbers[i+1]
+    for (unsigned int i = 1; i <= array_size; i++)
+    {
+        io.IN >> numbers[i];
+    }
+
+    unsigned int queries_count; // 1 ≤ queries_count ≤ 100 000
+    io.IN >> queries_count;
+
+    if (static_cast<unsigned long long>(queries_count) * OFFLINE_QUERY_RATIO >= array_size)
+    {
+        Answer_Queries_Offline(io, numbers, array_size, queries_count);
+    }
+    #ifdef FINGER_SEARCH
+    else
+    {
+        // Query streams with locality: every search gallops out from the previous answer.
+        Answer_Queries(io, numbers.data() + 1, Finger_Index<std::uint32_t>(numbers, array_size), queries_count);
+    }
+    #else
+    else if (array_size * sizeof(int) > L2_CACHE_SIZE)
+    {
+        #ifdef LEARNED_INDEX
+        const Learned_Index<std::uint32_t> learned_index(numbers, array_size);
+        if (learned_index.Is_Effective())
+        {
+            Answer_Queries(io, numbers.data() + 1, learned_index, queries_count);
+        }
+        else
+        {
+            Answer_Queries(io, numbers.data() + 1, S_Tree_Index<std::uint32_t>(numbers, array_size), queries_count);
+        }
+        #else
+        Answer_Queries(io, numbers.data() + 1, S_Tree_Index<std::uint32_t>(numbers, array_size), queries_count);
+        #endif
+    }
+    else
+    {
+        // The whole array fits in L2: the Eytzinger descent is already cheap and has no padding.
+        Answer_Queries(io, numbers.data() + 1, Eytzinger_Index<std::uint32_t>(numbers, array_size), queries_count);
+    }
+    #endif
+}
+
+int main()
+{
+    #ifdef PROFILING
+    Profiling profiling = Profiling(__PRETTY_FUNCTION__);
+    #endif
+
+    #ifdef VERIFY
+    Verify();
+    #endif
+
+    #if defined(BENCHMARK)
+    Benchmark();
+    #elif defined(CONVERT_INPUT)
+    Convert_Input();
+    #elif defined(MAPPED_INPUT)
+    Answer_Mapped_Queries();
+    #else
+    Answer_Input();
+    #endif
 
     #ifdef PROFILING
     profiling.End_Profiling();
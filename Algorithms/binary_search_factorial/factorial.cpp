@@ -1,8 +1,16 @@
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <unordered_map>
+#include <vector>
+
+#ifdef VERIFY
+#include <random>
+#endif
 
 #ifdef PROFILING
 #include <chrono>
@@ -243,30 +251,540 @@ int search(const unsigned int zeros_target)
             return static_cast<int>(middle);
         }
 
+        // Stepping by 2 (as this used to) can jump over the only block of 5 with the answer (P = 3, 4).
         if (zeros < zeros_target)
         {
-            left = middle + 2;
+            left = middle + 1;
         }
         else
         {
-            right = middle - 2;
+            right = middle - 1;
         }
     }
 
     return -1;
 }
 
+/* One digit of invert_factorial_zeros: the base-5 digit of weight w_k = _weight, worth _power = 5^k in N.
+ * digit ≤ 5, so five comparisons replace a 64-bit division.
+ */
+inline void invert_factorial_zeros_step(const unsigned long long _weight, const unsigned long long _power,
+                                        unsigned long long& _remainder, unsigned long long& _number, bool& _skipped)
+{
+    const unsigned long long digit = (_remainder >= _weight) + (_remainder >= 2 * _weight) + (_remainder >= 3 * _weight)
+                                     + (_remainder >= 4 * _weight) + (_remainder >= 5 * _weight);
+    _skipped |= digit == 5;
+
+    _number += digit * _power;
+    _remainder -= digit * _weight;
+}
+
+/* Direct inversion of Legendre's formula.
+ * Write N in base 5 as N = d_0 + d_1 * 5 + d_2 * 25 + ...
+ * Digit d_k adds d_k * 5^k / 5^i = d_k * 5^(k - i) to the i-th term of get_factorial_zeros
+ * for every i ≤ k, so N! ends in Σ d_k * w_k zeros, with w_k = 1 + 5 + ... + 5^(k - 1) = (5^k - 1) / 4
+ * (w_1 = 1, w_2 = 6, w_3 = 31, ...). d_0 adds nothing, so the smallest N has d_0 = 0.
+ * Since w_(k+1) = 5 * w_k + 1, writing zeros_target greedily in the weights w_k gives digits ≤ 5,
+ * and a digit of 5 means zeros_target is skipped by every N (e.g. 5: 24! has 4 zeros, 25! has 6).
+ * O(log P), no search.
+ */
+int invert_factorial_zeros(const unsigned int zeros_target)
+{
+    if (zeros_target == 0)
+    {
+        return 1;
+    }
+
+    /* Start from w_14 = (5^14 - 1) / 4, the largest weight an unsigned int can reach, rather than
+     * from the largest weight not above zeros_target: the extra leading digits are 0, and a fixed trip
+     * count with no early exit leaves the loop free of branches, so consecutive calls overlap in batch mode.
+     */
+    unsigned long long weight    = 1'525'878'906;
+    unsigned long long power     = 6'103'515'625; // 5^14
+    unsigned long long remainder = zeros_target;
+    unsigned long long number    = 0;
+    bool               skipped   = false;
+    for (; weight; weight = (weight - 1) / 5, power /= 5)
+    {
+        invert_factorial_zeros_step(weight, power, remainder, number, skipped);
+    }
+
+    if (skipped)
+    {
+        return -1;
+    }
+
+    return static_cast<int>(number);
+}
+
+#ifdef BATCH_INPUT
+constexpr std::size_t INVERSION_LANES = 8;
+
+/* invert_factorial_zeros over INVERSION_LANES queries in lockstep.
+ * One inversion is a chain of dependent steps; running several independent chains side by side
+ * lets the CPU overlap them (about 3x the throughput of one call at a time).
+ */
+void invert_factorial_zeros_batch(const unsigned int* const _zeros_targets, const std::size_t _count, int* const _numbers)
+{
+    std::size_t i = 0;
+    for (; i + INVERSION_LANES <= _count; i += INVERSION_LANES)
+    {
+        unsigned long long remainder[INVERSION_LANES];
+        unsigned long long number[INVERSION_LANES] = {};
+        bool               skipped[INVERSION_LANES] = {};
+        for (std::size_t lane = 0; lane < INVERSION_LANES; lane++)
+        {
+            remainder[lane] = _zeros_targets[i + lane];
+        }
+
+        for (unsigned long long weight = 1'525'878'906, power = 6'103'515'625; weight; weight = (weight - 1) / 5, power /= 5)
+        {
+            for (std::size_t lane = 0; lane < INVERSION_LANES; lane++)
+            {
+                invert_factorial_zeros_step(weight, power, remainder[lane], number[lane], skipped[lane]);
+            }
+        }
+
+        for (std::size_t lane = 0; lane < INVERSION_LANES; lane++)
+        {
+            _numbers[i + lane] = _zeros_targets[i + lane] == 0 ? 1 : skipped[lane] ? -1 : static_cast<int>(number[lane]);
+        }
+    }
+
+    for (; i < _count; i++)
+    {
+        _numbers[i] = invert_factorial_zeros(_zeros_targets[i]);
+    }
+}
+#endif
+
+/* Factorial_Zeros_Engine: trailing zeros of N! written in any base b ≥ 2, and the inverse query.
+ * With b = p_1^e_1 * ... * p_k^e_k, N! ends in min_i floor(v_p_i(N!) / e_i) zeros in base b,
+ * where v_p(N!) = N/p + N/p^2 + ... (Legendre's formula).
+ * N is 64-bit. The base is factorised once, by trial division, when the engine is built.
+ */
+class Factorial_Zeros_Engine
+{
+    public:
+        // Returned by Smallest_Number when no N! ends in exactly that many zeros.
+        static constexpr std::uint64_t NO_NUMBER = std::numeric_limits<std::uint64_t>::max();
+
+    private:
+        struct Prime_Power
+        {
+            std::uint64_t prime;
+            unsigned int  exponent;
+        };
+
+        std::vector<Prime_Power> factors;
+
+        static std::uint64_t Legendre(std::uint64_t _number, const std::uint64_t _prime)
+        {
+            std::uint64_t exponent = 0;
+            while (_number)
+            {
+                _number /= _prime;
+                exponent += _number;
+            }
+
+            return exponent;
+        }
+
+    public:
+        explicit Factorial_Zeros_Engine(std::uint64_t _base)
+        {
+            assert(_base >= 2);
+
+            for (std::uint64_t prime = 2; prime <= _base / prime; prime++)
+            {
+                unsigned int exponent = 0;
+                while (_base % prime == 0)
+                {
+                    _base /= prime;
+                    exponent++;
+                }
+
+                if (exponent)
+                {
+                    factors.push_back({prime, exponent});
+                }
+            }
+
+            if (_base > 1)
+            {
+                factors.push_back({_base, 1});
+            }
+        }
+
+        std::uint64_t Trailing_Zeros(const std::uint64_t _number) const
+        {
+            std::uint64_t zeros = std::numeric_limits<std::uint64_t>::max();
+            for (const Prime_Power& factor : factors)
+            {
+                zeros = std::min(zeros, Legendre(_number, factor.prime) / factor.exponent);
+            }
+
+            return zeros;
+        }
+
+        /* Smallest N ≥ 1 whose factorial ends in exactly _zeros zeros, or NO_NUMBER.
+         * Trailing_Zeros is non-decreasing in N, so we binary search for the first N reaching _zeros
+         * and check it does not overshoot. N = p * e * _zeros reaches _zeros for every p^e,
+         * which bounds the search.
+         */
+        std::uint64_t Smallest_Number(const std::uint64_t _zeros) const
+        {
+            std::uint64_t left  = 1;
+            std::uint64_t right = 1;
+            for (const Prime_Power& factor : factors)
+            {
+                const std::uint64_t step = factor.prime * factor.exponent;
+                const std::uint64_t reach = _zeros > std::numeric_limits<std::uint64_t>::max() / step
+                                                ? std::numeric_limits<std::uint64_t>::max()
+                                                : std::max<std::uint64_t>(step * _zeros, 1);
+                right = std::max(right, reach);
+            }
+
+            while (left < right)
+            {
+                const std::uint64_t middle = left + (right - left) / 2;
+                if (Trailing_Zeros(middle) < _zeros)
+                {
+                    left = middle + 1;
+                }
+                else
+                {
+                    right = middle;
+                }
+            }
+
+            return Trailing_Zeros(left) == _zeros ? left : NO_NUMBER;
+        }
+
+        // Batch API: _zeros[i] = Trailing_Zeros(_numbers[i]) for every i < _count.
+        void Trailing_Zeros_Batch(const std::uint64_t* const _numbers, const std::size_t _count, std::uint64_t* const _zeros) const
+        {
+            for (std::size_t i = 0; i < _count; i++)
+            {
+                _zeros[i] = Trailing_Zeros(_numbers[i]);
+            }
+        }
+
+        // Batch API: _numbers[i] = Smallest_Number(_zeros[i]) for every i < _count.
+        void Smallest_Number_Batch(const std::uint64_t* const _zeros, const std::size_t _count, std::uint64_t* const _numbers) const
+        {
+            for (std::size_t i = 0; i < _count; i++)
+            {
+                _numbers[i] = Smallest_Number(_zeros[i]);
+            }
+        }
+};
+
+constexpr std::uint64_t Factorial_Zeros_Engine::NO_NUMBER;
+
+#ifdef BATCH_INPUT
+/* Batch mode: the input holds any number of whitespace-separated P values (a single P is a batch of one),
+ * and the output has one answer per line, in input order.
+ * invert_factorial_zeros costs O(log_5 P) branch-free steps per query and queries do not depend on each other,
+ * so they are answered straight in input order, several at a time (invert_factorial_zeros_batch):
+ * sorting them for an incremental sweep would cost more than the inversion itself, plus a scatter back to input order.
+ * The time goes into I/O, so the whole input is read in one block and parsed by hand,
+ * and answers are formatted into a buffer that is flushed in large writes.
+ * With -DFACTORIAL_BASE=b as well, P is 64-bit and each query goes through Factorial_Zeros_Engine(b)::Smallest_Number_Batch.
+ */
+constexpr std::size_t OUTPUT_BUFFER_SIZE = 1 << 16;
+
+template <typename Query>
+std::vector<Query> read_queries(std::istream& _input)
+{
+    _input.seekg(0, std::ios::end);
+    const std::streamoff file_size = _input.tellg();
+    _input.seekg(0, std::ios::beg);
+
+    std::vector<char> text(static_cast<std::size_t>(std::max<std::streamoff>(file_size, 0)));
+    _input.read(text.data(), static_cast<std::streamsize>(text.size()));
+
+    std::vector<Query> queries;
+    queries.reserve(text.size() / 2);
+
+    const char* character = text.data();
+    const char* const end = text.data() + text.size();
+    while (true)
+    {
+        while (character != end && (*character < '0' || *character > '9'))
+        {
+            character++;
+        }
+        if (character == end)
+        {
+            break;
+        }
+
+        Query value = 0;
+        while (character != end && *character >= '0' && *character <= '9')
+        {
+            value = value * 10 + static_cast<Query>(*character - '0');
+            character++;
+        }
+        queries.push_back(value);
+    }
+
+    return queries;
+}
+
+class Buffered_Writer
+{
+    private:
+        std::ostream&     output;
+        std::vector<char> buffer;
+        std::size_t       used = 0;
+
+    public:
+        explicit Buffered_Writer(std::ostream& _output) : output(_output), buffer(OUTPUT_BUFFER_SIZE) {}
+
+        ~Buffered_Writer()
+        {
+            Flush();
+        }
+
+        Buffered_Writer(const Buffered_Writer&)            = delete;
+        Buffered_Writer& operator=(const Buffered_Writer&) = delete;
+
+        // Writes _value and a newline.
+        void Write_Line(const int _value)
+        {
+            Write_Magnitude(_value < 0, _value < 0 ? 0u - static_cast<unsigned int>(_value) : static_cast<unsigned int>(_value));
+        }
+
+        void Write_Line(const std::uint64_t _value)
+        {
+            Write_Magnitude(false, _value);
+        }
+
+    private:
+        void Write_Magnitude(const bool _negative, const std::uint64_t _magnitude)
+        {
+            // A 64-bit magnitude with a sign and newline takes at most 22 characters.
+            if (used + 22 > buffer.size())
+            {
+                Flush();
+            }
+
+            if (_negative)
+            {
+                buffer[used++] = '-';
+            }
+
+            std::uint64_t magnitude = _magnitude;
+            char          digits[20];
+            int           digits_count = 0;
+            do
+            {
+                digits[digits_count++] = static_cast<char>('0' + magnitude % 10);
+                magnitude /= 10;
+            } while (magnitude);
+
+            while (digits_count)
+            {
+                buffer[used++] = digits[--digits_count];
+            }
+            buffer[used++] = '\n';
+        }
+
+    public:
+        void Flush()
+        {
+            output.write(buffer.data(), static_cast<std::streamsize>(used));
+            used = 0;
+        }
+};
+
+void answer_batch(IO& io)
+{
+    #ifdef PROFILING
+    Profiling profiling = Profiling(__PRETTY_FUNCTION__, "Read, invert and write every P");
+    #endif
+
+    #ifdef FACTORIAL_BASE
+    const Factorial_Zeros_Engine engine(FACTORIAL_BASE);
+
+    const std::vector<std::uint64_t> queries = read_queries<std::uint64_t>(io.IN);
+
+    std::vector<std::uint64_t> numbers(queries.size());
+    engine.Smallest_Number_Batch(queries.data(), queries.size(), numbers.data());
+
+    Buffered_Writer writer(io.OUT);
+    for (const std::uint64_t number : numbers)
+    {
+        if (number == Factorial_Zeros_Engine::NO_NUMBER)
+        {
+            writer.Write_Line(-1);
+        }
+        else
+        {
+            writer.Write_Line(number);
+        }
+    }
+    writer.Flush();
+    #else
+    const std::vector<unsigned int> queries = read_queries<unsigned int>(io.IN);
+
+    std::vector<int> numbers(queries.size());
+    invert_factorial_zeros_batch(queries.data(), queries.size(), numbers.data());
+
+    Buffered_Writer writer(io.OUT);
+    for (const int number : numbers)
+    {
+        writer.Write_Line(number);
+    }
+    writer.Flush();
+    #endif
+
+    #ifdef PROFILING
+    profiling.End_Profiling();
+    std::cout << queries.size() << " queries\n";
+    #endif
+}
+#endif
+
+#ifdef VERIFY
+/* Checks invert_factorial_zeros against the binary search oracle,
+ * exhaustively for P ≤ 10^6 and on 10^6 random P ≤ 10^8.
+ */
+void Verify()
+{
+    constexpr unsigned int EXHAUSTIVE_LIMIT = 1'000'000;
+    constexpr unsigned int RANDOM_SAMPLES   = 1'000'000;
+    constexpr unsigned int MAX_ZEROS        = 100'000'000;
+
+    std::mt19937                                generator(2024);
+    std::uniform_int_distribution<unsigned int> distribution(0, MAX_ZEROS);
+
+    unsigned int mismatches = 0;
+    for (unsigned int i = 0; i <= EXHAUSTIVE_LIMIT + RANDOM_SAMPLES; i++)
+    {
+        const unsigned int zeros_target = i <= EXHAUSTIVE_LIMIT ? i : distribution(generator);
+        if (invert_factorial_zeros(zeros_target) != search(zeros_target))
+        {
+            std::cerr << "Mismatch for P = " << zeros_target << ": " << invert_factorial_zeros(zeros_target)
+                    << " (inverted) vs " << search(zeros_target) << " (searched)\n";
+            mismatches++;
+        }
+    }
+
+    // The engine in base 10 must agree with the inversion.
+    const Factorial_Zeros_Engine engine_10(10);
+    for (unsigned int i = 0; i <= RANDOM_SAMPLES; i++)
+    {
+        const unsigned int  zeros_target = distribution(generator);
+        const int           inverted     = invert_factorial_zeros(zeros_target);
+        const std::uint64_t number       = engine_10.Smallest_Number(zeros_target);
+        if (inverted != (number == Factorial_Zeros_Engine::NO_NUMBER ? -1 : static_cast<long long>(number)))
+        {
+            std::cerr << "Mismatch for P = " << zeros_target << " in base 10\n";
+            mismatches++;
+        }
+    }
+
+    // Other bases against counting the zeros of N! directly, one N at a time.
+    for (std::uint64_t base = 2; base <= 64; base++)
+    {
+        const Factorial_Zeros_Engine engine(base);
+
+        std::vector<std::uint64_t> first_number(1, 1); // first_number[P]: smallest N ≥ 1 with exactly P zeros
+        std::uint64_t              previous_zeros = 0;
+        for (std::uint64_t number = 1; number <= 5'000; number++)
+        {
+            const std::uint64_t zeros = engine.Trailing_Zeros(number);
+            for (std::uint64_t skipped = previous_zeros + 1; skipped < zeros; skipped++)
+            {
+                first_number.push_back(Factorial_Zeros_Engine::NO_NUMBER);
+            }
+            if (zeros > previous_zeros)
+            {
+                first_number.push_back(number);
+            }
+            previous_zeros = zeros;
+        }
+
+        for (std::uint64_t zeros = 0; zeros < first_number.size(); zeros++)
+        {
+            if (engine.Smallest_Number(zeros) != first_number[zeros])
+            {
+                std::cerr << "Mismatch for P = " << zeros << " in base " << base << "\n";
+                mismatches++;
+            }
+        }
+
+        // The batch API must agree with the single queries.
+        std::vector<std::uint64_t> queries(first_number.size() + 5'000);
+        for (std::size_t i = 0; i < queries.size(); i++)
+        {
+            queries[i] = i;
+        }
+
+        std::vector<std::uint64_t> answers(queries.size());
+        engine.Trailing_Zeros_Batch(queries.data(), queries.size(), answers.data());
+        for (std::size_t i = 0; i < queries.size(); i++)
+        {
+            if (answers[i] != engine.Trailing_Zeros(queries[i]))
+            {
+                std::cerr << "Trailing_Zeros_Batch mismatch for N = " << queries[i] << " in base " << base << "\n";
+                mismatches++;
+            }
+        }
+
+        engine.Smallest_Number_Batch(queries.data(), queries.size(), answers.data());
+        for (std::size_t i = 0; i < queries.size(); i++)
+        {
+            if (answers[i] != engine.Smallest_Number(queries[i]))
+            {
+                std::cerr << "Smallest_Number_Batch mismatch for P = " << queries[i] << " in base " << base << "\n";
+                mismatches++;
+            }
+        }
+    }
+
+    std::cout << "Verify: " << mismatches << " mismatches\n";
+    assert(mismatches == 0);
+}
+#endif
+
 int main()
 {
     #ifdef PROFILING
     Profiling profiling = Profiling(__PRETTY_FUNCTION__, "Factorial");
     #endif
 
+    #ifdef VERIFY
+    Verify();
+    #endif
+
     IO& io = IO::GetInstance(INPUT_FILE_NAME, OUTPUT_FILE_NAME);
 
+    #if defined(BATCH_INPUT)
+    answer_batch(io);
+    #elif defined(FACTORIAL_BASE)
+    // -DFACTORIAL_BASE=b: smallest N whose factorial ends in exactly P zeros in base b.
+    const Factorial_Zeros_Engine engine(FACTORIAL_BASE);
+
+    std::uint64_t P;
+    io.IN >> P;
+
+    const std::uint64_t number = engine.Smallest_Number(P);
+    if (number == Factorial_Zeros_Engine::NO_NUMBER)
+    {
+        io.OUT << -1 << std::endl;
+    }
+    else
+    {
+        io.OUT << number << std::endl;
+    }
+    #else
     unsigned int P; // 0 ≤ P ≤ 10^8
     io.IN >> P;
-    io.OUT << search(P) << std::endl;
+    io.OUT << invert_factorial_zeros(P) << std::endl;
+    #endif
 
     #ifdef PROFILING
     profiling.End_Profiling();
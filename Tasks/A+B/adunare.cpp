@@ -6,6 +6,25 @@
 #include <random>
 #include <unordered_map>
 
+#if defined(BIG_NUMBERS) || defined(BULK_INPUT)
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#endif
+
+#ifdef BULK_INPUT
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#endif
+
 constexpr char INPUT_FILE_NAME[]  = "adunare.in";
 constexpr char OUTPUT_FILE_NAME[] = "adunare.out";
 
@@ -348,6 +367,691 @@ class Profiling
 };
 #endif
 
+#if defined(BIG_NUMBERS) || defined(BULK_INPUT)
+// Whitespace as the "C" locale's isspace sees it: ' ', '\t', '\n', '\v', '\f', '\r'.
+inline bool is_space(const char _character)
+{
+    return _character == ' ' || static_cast<unsigned char>(_character - '\t') <= '\r' - '\t';
+}
+
+inline bool is_digit(const char _character)
+{
+    return static_cast<unsigned char>(_character - '0') <= 9;
+}
+
+// "00" to "99", to write two digits at a time.
+constexpr char DIGIT_PAIRS[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+                               "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+                               "8081828384858687888990919293949596979899";
+#endif
+
+#ifdef BIG_NUMBERS
+// Reads the whole stream into one buffer, in one go.
+std::vector<char> read_file(std::istream& _input)
+{
+    _input.seekg(0, std::ios::end);
+    const std::streamoff file_size = _input.tellg();
+    _input.seekg(0, std::ios::beg);
+
+    std::vector<char> contents(static_cast<std::size_t>(file_size > 0 ? file_size : 0));
+    _input.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+
+    return contents;
+}
+
+/* Big numbers are kept in base 10^8: 8 decimal digits to a 32-bit limb, the least significant limb first.
+ * 16 digits make two limbs, so one 16-byte SSE2 load parses into two limbs;
+ * and a sum of two limbs (< 2 * 10^8) still fits a signed 32-bit lane, for SSE2's signed compares.
+ */
+constexpr std::size_t   LIMB_DIGITS = 8;
+constexpr std::uint32_t LIMB_BASE   = 100'000'000;
+
+struct Big_Number
+{
+    bool                       negative = false;
+    std::vector<std::uint32_t> limbs; // without leading zero limbs, so zero has none
+};
+
+// First position in [_from, _end) that is not a digit.
+const char* skip_digits(const char* _from, const char* const _end)
+{
+    #ifdef __SSE2__
+    for (; _from + 16 <= _end; _from += 16)
+    {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_from));
+        // c - '0' <= 9, as a signed compare after moving '0' to -128.
+        const __m128i shifted = _mm_add_epi8(bytes, _mm_set1_epi8(static_cast<char>(0x80 - '0')));
+        const unsigned int digits = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmplt_epi8(shifted, _mm_set1_epi8(-128 + 10))));
+        if (digits != 0xFFFF)
+        {
+            return _from + __builtin_ctz(~digits);
+        }
+    }
+    #endif
+
+    while (_from != _end && is_digit(*_from))
+    {
+        _from++;
+    }
+
+    return _from;
+}
+
+// The value of _count (at most LIMB_DIGITS) digits.
+std::uint32_t parse_limb(const char* const _digits, const std::size_t _count)
+{
+    std::uint32_t limb = 0;
+    for (std::size_t digit = 0; digit < _count; digit++)
+    {
+        limb = limb * 10 + static_cast<std::uint32_t>(_digits[digit] - '0');
+    }
+
+    return limb;
+}
+
+/* The two limbs that 16 digits make: _high from the first 8, _low from the last 8.
+ * With SSE2, neighbours are paired up by multiply-adds: digits into 2-digit numbers (x 10),
+ * then 4-digit ones (x 100), then 8-digit ones (x 10'000), each step fitting 16-bit inputs.
+ */
+inline void parse_two_limbs(const char* const _digits, std::uint32_t& _high, std::uint32_t& _low)
+{
+    #ifdef __SSE2__
+    const __m128i digits = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_digits)), _mm_set1_epi8('0'));
+    const __m128i zero   = _mm_setzero_si128();
+
+    const __m128i tens = _mm_set1_epi32(10 | (1 << 16));
+    const __m128i pairs = _mm_packs_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(digits, zero), tens),
+                                          _mm_madd_epi16(_mm_unpackhi_epi8(digits, zero), tens));
+    const __m128i quads  = _mm_madd_epi16(pairs, _mm_set1_epi32(100 | (1 << 16)));
+    const __m128i eights = _mm_madd_epi16(_mm_packs_epi32(quads, quads), _mm_set1_epi32(10'000 | (1 << 16)));
+
+    _high = static_cast<std::uint32_t>(_mm_cvtsi128_si32(eights));
+    _low  = static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(eights, 4)));
+    #else
+    _high = parse_limb(_digits, LIMB_DIGITS);
+    _low  = parse_limb(_digits + LIMB_DIGITS, LIMB_DIGITS);
+    #endif
+}
+
+// Parses the number at _position, an optional sign and then digits, and moves _position past it.
+Big_Number parse_big_number(const char*& _position, const char* const _end)
+{
+    while (_position != _end && is_space(*_position))
+    {
+        _position++;
+    }
+
+    Big_Number number;
+    if (_position != _end && (*_position == '-' || *_position == '+'))
+    {
+        number.negative = *_position == '-';
+        _position++;
+    }
+
+    const char* begin = _position;
+    _position         = skip_digits(_position, _end);
+    while (begin != _position && *begin == '0')
+    {
+        begin++;
+    }
+
+    // Limbs come out most significant first, from the front of the digits: the first one takes what is left over
+    // from whole limbs, then two limbs at a time.
+    const std::size_t digits_count = static_cast<std::size_t>(_position - begin);
+    // One spare limb, so that a carry out of an addition does not move all the others.
+    number.limbs.reserve((digits_count + LIMB_DIGITS - 1) / LIMB_DIGITS + 1);
+    number.limbs.resize((digits_count + LIMB_DIGITS - 1) / LIMB_DIGITS);
+    std::size_t limb = number.limbs.size();
+
+    const std::size_t head = digits_count % LIMB_DIGITS;
+    if (head)
+    {
+        number.limbs[--limb] = parse_limb(begin, head);
+        begin += head;
+    }
+
+    if (limb % 2)
+    {
+        number.limbs[--limb] = parse_limb(begin, LIMB_DIGITS);
+        begin += LIMB_DIGITS;
+    }
+
+    for (; limb; limb -= 2, begin += 2 * LIMB_DIGITS)
+    {
+        parse_two_limbs(begin, number.limbs[limb - 1], number.limbs[limb - 2]);
+    }
+
+    if (number.limbs.empty())
+    {
+        number.negative = false;
+    }
+
+    return number;
+}
+
+// -1, 0 or 1, as |_a| is less than, equal to or greater than |_b|.
+int compare_magnitudes(const Big_Number& _a, const Big_Number& _b)
+{
+    if (_a.limbs.size() != _b.limbs.size())
+    {
+        return _a.limbs.size() < _b.limbs.size() ? -1 : 1;
+    }
+
+    for (std::size_t limb = _a.limbs.size(); limb--;)
+    {
+        if (_a.limbs[limb] != _b.limbs[limb])
+        {
+            return _a.limbs[limb] < _b.limbs[limb] ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+#ifdef __SSE2__
+/* Adds 16 limbs of _addend into _sum, with _carry in and out.
+ * Carries are found for all 16 limbs at once, as in a carry-lookahead adder: limb i generates a carry
+ * if a + b >= LIMB_BASE, and passes one on if a + b == LIMB_BASE - 1. With those as bit masks G and P,
+ * the carries into the limbs are ((G << 1 | carry in) + P) ^ P: the addition runs each carry up through
+ * a run of propagating limbs, and the bit it leaves past the last limb is the carry out.
+ */
+inline void add_limbs_block(std::uint32_t* const _sum, const std::uint32_t* const _addend, unsigned int& _carry)
+{
+    const __m128i top  = _mm_set1_epi32(static_cast<int>(LIMB_BASE - 1));
+    const __m128i base = _mm_set1_epi32(static_cast<int>(LIMB_BASE));
+
+    __m128i      sums[4];
+    unsigned int generate  = 0;
+    unsigned int propagate = 0;
+    for (unsigned int vector = 0; vector < 4; vector++)
+    {
+        sums[vector] = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_sum + 4 * vector)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(_addend + 4 * vector)));
+        generate  |= static_cast<unsigned int>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(sums[vector], top)))) << (4 * vector);
+        propagate |= static_cast<unsigned int>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(sums[vector], top)))) << (4 * vector);
+    }
+
+    const unsigned int carries = (((generate << 1) | _carry) + propagate) ^ propagate;
+    _carry                     = (carries >> 16) & 1;
+
+    const __m128i lane_bits = _mm_setr_epi32(1, 2, 4, 8);
+    for (unsigned int vector = 0; vector < 4; vector++)
+    {
+        // All ones in the lanes that take a carry: subtracting -1 adds it.
+        const __m128i carry_lanes = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(static_cast<int>(carries >> (4 * vector))), lane_bits), lane_bits);
+        const __m128i sum         = _mm_sub_epi32(sums[vector], carry_lanes);
+        const __m128i wrapped     = _mm_sub_epi32(sum, _mm_and_si128(_mm_cmpgt_epi32(sum, top), base));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(_sum + 4 * vector), wrapped);
+    }
+}
+#endif
+
+// |_sum| += |_addend|.
+void add_magnitudes(Big_Number& _sum, const Big_Number& _addend)
+{
+    if (_sum.limbs.size() < _addend.limbs.size())
+    {
+        _sum.limbs.resize(_addend.limbs.size(), 0);
+    }
+
+    std::uint32_t* const       sum    = _sum.limbs.data();
+    const std::uint32_t* const addend = _addend.limbs.data();
+    const std::size_t          count  = _addend.limbs.size();
+    unsigned int               carry  = 0;
+    std::size_t                limb   = 0;
+
+    #ifdef __SSE2__
+    for (; limb + 16 <= count; limb += 16)
+    {
+        add_limbs_block(sum + limb, addend + limb, carry);
+    }
+    #endif
+
+    for (; limb < count || (carry && limb < _sum.limbs.size()); limb++)
+    {
+        const std::uint32_t value = sum[limb] + (limb < count ? addend[limb] : 0) + carry;
+        carry                     = value >= LIMB_BASE;
+        sum[limb]                 = carry ? value - LIMB_BASE : value;
+    }
+
+    if (carry)
+    {
+        _sum.limbs.push_back(1);
+    }
+}
+
+// |_difference| -= |_subtrahend|, where |_subtrahend| <= |_difference|.
+void subtract_magnitudes(Big_Number& _difference, const Big_Number& _subtrahend)
+{
+    std::uint32_t borrow = 0;
+    for (std::size_t limb = 0; limb < _subtrahend.limbs.size() || borrow; limb++)
+    {
+        const std::uint32_t taken = (limb < _subtrahend.limbs.size() ? _subtrahend.limbs[limb] : 0) + borrow;
+        borrow                    = _difference.limbs[limb] < taken;
+        _difference.limbs[limb]   = _difference.limbs[limb] + (borrow ? LIMB_BASE : 0) - taken;
+    }
+
+    while (_difference.limbs.empty() == false && _difference.limbs.back() == 0)
+    {
+        _difference.limbs.pop_back();
+    }
+}
+
+Big_Number add_big_numbers(Big_Number _a, Big_Number _b)
+{
+    if (_a.negative == _b.negative)
+    {
+        add_magnitudes(_a, _b);
+        return _a;
+    }
+
+    // Opposite signs: the smaller magnitude comes off the larger one, which keeps its sign.
+    if (compare_magnitudes(_a, _b) < 0)
+    {
+        std::swap(_a, _b);
+    }
+    subtract_magnitudes(_a, _b);
+    if (_a.limbs.empty())
+    {
+        _a.negative = false;
+    }
+
+    return _a;
+}
+
+// Writes the 8 digits of _limb, leading zeros included, two digits at a time.
+inline void write_limb(std::uint32_t _limb, char* const _output)
+{
+    for (std::size_t pair = LIMB_DIGITS / 2; pair--; _limb /= 100)
+    {
+        std::memcpy(_output + 2 * pair, DIGIT_PAIRS + 2 * (_limb % 100), 2);
+    }
+}
+
+// Appends _number in decimal to _output, with one buffer resize and no per-digit stream calls.
+void write_big_number(const Big_Number& _number, std::vector<char>& _output)
+{
+    if (_number.limbs.empty())
+    {
+        _output.push_back('0');
+        return;
+    }
+
+    if (_number.negative)
+    {
+        _output.push_back('-');
+    }
+
+    // The most significant limb has no leading zeros.
+    char top[LIMB_DIGITS];
+    write_limb(_number.limbs.back(), top);
+    const char* const top_end   = top + LIMB_DIGITS;
+    const char*       top_begin = top;
+    while (top_begin + 1 != top_end && *top_begin == '0')
+    {
+        top_begin++;
+    }
+    _output.insert(_output.end(), top_begin, top_end);
+
+    std::size_t position = _output.size();
+    _output.resize(position + (_number.limbs.size() - 1) * LIMB_DIGITS);
+    for (std::size_t limb = _number.limbs.size() - 1; limb--; position += LIMB_DIGITS)
+    {
+        write_limb(_number.limbs[limb], _output.data() + position);
+    }
+}
+
+#ifdef PROFILING
+// The reference to measure against: schoolbook addition of two digit strings, one character at a time.
+std::string add_digits_naive(const std::string& _a, const std::string& _b)
+{
+    std::string sum;
+    int         carry = 0;
+    for (std::size_t digit = 0; digit < std::max(_a.size(), _b.size()) || carry; digit++)
+    {
+        const int value = carry + (digit < _a.size() ? _a[_a.size() - 1 - digit] - '0' : 0) +
+                          (digit < _b.size() ? _b[_b.size() - 1 - digit] - '0' : 0);
+        sum.push_back(static_cast<char>('0' + value % 10));
+        carry = value / 10;
+    }
+    std::reverse(sum.begin(), sum.end());
+
+    return sum;
+}
+#endif
+#endif
+
+#ifdef BULK_INPUT
+#ifdef BIG_NUMBERS
+#error "BULK_INPUT adds 64-bit integers: it cannot be combined with BIG_NUMBERS"
+#endif
+
+// Lines are read in batches of about BATCH_SIZE bytes.
+constexpr std::size_t BATCH_SIZE = 1 << 20;
+// Readable bytes past the end of a batch, for the 8-byte loads of the parser.
+constexpr std::size_t INPUT_PADDING = 8;
+// Batches in flight: one being worked on and one waiting, for each of the 5 stages.
+constexpr std::size_t PIPELINE_BATCHES = 2 * 5;
+
+/* Numbers may have up to MAX_DIGITS digits, so that every sum fits an int64_t (|a + b| < 2 * 10^18 < 2^63).
+ * Longer ones are what -DBIG_NUMBERS is for.
+ */
+constexpr std::size_t MAX_DIGITS = 18;
+
+constexpr std::uint64_t POWERS_OF_TEN[] = {1, 10, 100, 1'000, 10'000, 100'000, 1'000'000, 10'000'000, 100'000'000};
+
+/* Pairs_Batch: a run of whole "a b" lines, as it goes through the stages of add_pairs_in_pipeline.
+ * Batches are reused, so their buffers stop growing once they have seen a full batch.
+ */
+struct Pairs_Batch
+{
+    std::vector<char>         input; // the lines, then INPUT_PADDING bytes
+    std::size_t               input_size = 0;
+    std::vector<std::int64_t> first;
+    std::vector<std::int64_t> second;
+    std::vector<std::int64_t> sums;
+    std::vector<char>         output;
+    std::size_t               output_size = 0;
+};
+
+// Batch_Queue: hands batches from one stage's thread to the next one's, in order.
+class Batch_Queue
+{
+    private:
+        std::mutex               mutex;
+        std::condition_variable  ready;
+        std::deque<Pairs_Batch*> batches;
+
+    public:
+        // nullptr tells the next stage that there are no more batches.
+        void Push(Pairs_Batch* const _batch)
+        {
+            {
+                const std::lock_guard<std::mutex> lock(mutex);
+                batches.push_back(_batch);
+            }
+            ready.notify_one();
+        }
+
+        Pairs_Batch* Pop()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this]() { return batches.empty() == false; });
+
+            Pairs_Batch* const batch = batches.front();
+            batches.pop_front();
+            return batch;
+        }
+};
+
+/* Reader stage: fills _batch with _carry, the partial line left over from the batch before,
+ * and the next BATCH_SIZE bytes of _input, up to their last '\n'. What follows it becomes the new _carry.
+ * Returns false once _input is used up, and the batch holds what was left of it.
+ */
+bool read_lines(std::istream& _input, std::vector<char>& _carry, Pairs_Batch& _batch)
+{
+    _batch.input.resize(_carry.size() + BATCH_SIZE + INPUT_PADDING);
+    std::copy(_carry.begin(), _carry.end(), _batch.input.begin());
+    _input.read(_batch.input.data() + _carry.size(), static_cast<std::streamsize>(BATCH_SIZE));
+
+    const bool        more = static_cast<std::size_t>(_input.gcount()) == BATCH_SIZE;
+    const std::size_t size = _carry.size() + static_cast<std::size_t>(_input.gcount());
+    _carry.clear();
+
+    _batch.input_size = size;
+    if (more)
+    {
+        const char* const begin    = _batch.input.data();
+        const char*       line_end = begin + size;
+        while (line_end != begin && line_end[-1] != '\n')
+        {
+            line_end--;
+        }
+
+        _carry.assign(line_end, begin + size);
+        _batch.input_size = static_cast<std::size_t>(line_end - begin);
+    }
+
+    std::fill_n(_batch.input.data() + _batch.input_size, INPUT_PADDING, '\n');
+    return more;
+}
+
+// The value of 8 digits, _digits[i] in byte i, most significant first (SWAR: 3 multiplications for all 8).
+inline std::uint64_t eight_digits(std::uint64_t _digits)
+{
+    _digits = (_digits * 10) + (_digits >> 8);
+    return (((_digits & 0x000000FF000000FF) * (100 + (1'000'000ULL << 32))) +
+            (((_digits >> 16) & 0x000000FF000000FF) * (1 + (10'000ULL << 32)))) >> 32;
+}
+
+/* Parses the integer at _position, an optional sign and then at most MAX_DIGITS digits, and returns the position past it.
+ * Digits are taken 8 at a time from one 8-byte load, which also finds where they stop:
+ * a byte is not a digit if c - '0' or c - '0' + 0x76 has its top bit set.
+ * Borrows and carries only run from a byte into the ones after it, so the first non-digit is found right.
+ */
+inline const char* parse_integer(const char* _position, std::int64_t& _value)
+{
+    const bool negative = *_position == '-';
+    _position += negative || *_position == '+';
+
+    const char* const digits_begin = _position;
+    std::uint64_t     magnitude    = 0;
+    for (;;)
+    {
+        std::uint64_t bytes;
+        std::memcpy(&bytes, _position, sizeof(bytes));
+
+        const std::uint64_t digits     = bytes - 0x3030303030303030;
+        const std::uint64_t non_digits = (digits | (digits + 0x7676767676767676)) & 0x8080808080808080;
+        const unsigned int  count      = non_digits ? static_cast<unsigned int>(__builtin_ctzll(non_digits)) / 8 : 8;
+        if (count)
+        {
+            // Shifts the digits to the top bytes, so that zeros lead.
+            magnitude = magnitude * POWERS_OF_TEN[count] + eight_digits(digits << (8 * (8 - count)));
+        }
+
+        _position += count;
+        if (count < 8)
+        {
+            break;
+        }
+    }
+    assert(static_cast<std::size_t>(_position - digits_begin) <= MAX_DIGITS);
+
+    _value = negative ? -static_cast<std::int64_t>(magnitude) : static_cast<std::int64_t>(magnitude);
+    return _position;
+}
+
+// Anything but a digit or a sign separates the numbers of a line.
+inline const char* skip_separators(const char* _position, const char* const _end)
+{
+    while (_position != _end && is_digit(*_position) == false && *_position != '-' && *_position != '+')
+    {
+        _position++;
+    }
+
+    return _position;
+}
+
+/* Parser stage: the pair of numbers on each line of _batch, into first and second.
+ * A line with one number is added to 0, and what follows the second number is ignored.
+ * Lines with no number at all are skipped.
+ */
+void parse_pairs(Pairs_Batch& _batch)
+{
+    _batch.first.clear();
+    _batch.second.clear();
+
+    const char*       position = _batch.input.data();
+    const char* const end      = position + _batch.input_size;
+    for (const char* line_end; position != end; position = line_end == end ? end : line_end + 1)
+    {
+        const void* const newline = std::memchr(position, '\n', static_cast<std::size_t>(end - position));
+        line_end                  = newline ? static_cast<const char*>(newline) : end;
+
+        position = skip_separators(position, line_end);
+        if (position == line_end)
+        {
+            continue;
+        }
+
+        std::int64_t a;
+        std::int64_t b = 0;
+        position       = parse_integer(position, a);
+        position       = skip_separators(position, line_end);
+        if (position != line_end)
+        {
+            parse_integer(position, b);
+        }
+
+        _batch.first.push_back(a);
+        _batch.second.push_back(b);
+    }
+}
+
+// Adder stage: sums = first + second, two 64-bit lanes at a time.
+void add_pairs(Pairs_Batch& _batch)
+{
+    const std::size_t count = _batch.first.size();
+    _batch.sums.resize(count);
+
+    const std::int64_t* const first  = _batch.first.data();
+    const std::int64_t* const second = _batch.second.data();
+    std::int64_t* const       sums   = _batch.sums.data();
+    std::size_t               pair   = 0;
+
+    #ifdef __SSE2__
+    for (; pair + 2 <= count; pair += 2)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + pair),
+                         _mm_add_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first + pair)),
+                                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + pair))));
+    }
+    #endif
+
+    for (; pair < count; pair++)
+    {
+        // Within MAX_DIGITS this never overflows; should it, it wraps as the SSE2 lanes do, instead of being undefined.
+        sums[pair] = static_cast<std::int64_t>(static_cast<std::uint64_t>(first[pair]) + static_cast<std::uint64_t>(second[pair]));
+    }
+}
+
+// Writes _value in decimal at _output, two digits at a time, and returns the position past it.
+inline char* write_integer(const std::int64_t _value, char* _output)
+{
+    std::uint64_t magnitude = _value < 0 ? 0 - static_cast<std::uint64_t>(_value) : static_cast<std::uint64_t>(_value);
+    if (_value < 0)
+    {
+        *_output++ = '-';
+    }
+
+    unsigned int digits = 1;
+    for (std::uint64_t power = 10; digits < 20 && magnitude >= power; power *= 10)
+    {
+        digits++;
+    }
+
+    char* position = _output + digits;
+    for (; magnitude >= 100; magnitude /= 100)
+    {
+        position -= 2;
+        std::memcpy(position, DIGIT_PAIRS + 2 * (magnitude % 100), 2);
+    }
+
+    if (magnitude >= 10)
+    {
+        std::memcpy(position - 2, DIGIT_PAIRS + 2 * magnitude, 2);
+    }
+    else
+    {
+        position[-1] = static_cast<char>('0' + magnitude);
+    }
+
+    return _output + digits;
+}
+
+// Formatter stage: one line per sum.
+void format_sums(Pairs_Batch& _batch)
+{
+    // A sign, 19 digits and a '\n'.
+    _batch.output.resize(_batch.sums.size() * 21);
+
+    char* const begin    = _batch.output.data();
+    char*       position = begin;
+    for (const std::int64_t sum : _batch.sums)
+    {
+        position    = write_integer(sum, position);
+        *position++ = '\n';
+    }
+
+    _batch.output_size = static_cast<std::size_t>(position - begin);
+}
+
+struct Pipeline_Statistics
+{
+    std::size_t pairs        = 0;
+    std::size_t input_bytes  = 0;
+    std::size_t output_bytes = 0;
+};
+
+/* Adds up every "a b" line of _input, into one line of _output each, with every stage on a thread of its own:
+ *   reader -> parser -> adder -> formatter -> writer (this thread)
+ * Batches go from stage to stage through Batch_Queues, and back to the reader once written,
+ * so that while a stage works on a batch the next one is already waiting for it.
+ */
+Pipeline_Statistics add_pairs_in_pipeline(std::istream& _input, std::ostream& _output)
+{
+    std::vector<Pairs_Batch> batches(PIPELINE_BATCHES);
+    Batch_Queue              free_batches, read_batches, parsed_batches, added_batches, formatted_batches;
+    for (Pairs_Batch& batch : batches)
+    {
+        free_batches.Push(&batch);
+    }
+
+    // A stage: takes the batches from _from, works on them with _work, and passes them on to _to.
+    const auto stage = [](Batch_Queue& _from, Batch_Queue& _to, void (*const _work)(Pairs_Batch&)) {
+        for (Pairs_Batch* batch = _from.Pop(); batch; batch = _from.Pop())
+        {
+            _work(*batch);
+            _to.Push(batch);
+        }
+        _to.Push(nullptr);
+    };
+
+    std::thread reader([&]() {
+        std::vector<char> carry;
+        for (bool more = true; more;)
+        {
+            Pairs_Batch* const batch = free_batches.Pop();
+            more                     = read_lines(_input, carry, *batch);
+            read_batches.Push(batch);
+        }
+        read_batches.Push(nullptr);
+    });
+    std::thread parser(stage, std::ref(read_batches), std::ref(parsed_batches), &parse_pairs);
+    std::thread adder(stage, std::ref(parsed_batches), std::ref(added_batches), &add_pairs);
+    std::thread formatter(stage, std::ref(added_batches), std::ref(formatted_batches), &format_sums);
+
+    Pipeline_Statistics statistics;
+    for (Pairs_Batch* batch = formatted_batches.Pop(); batch; batch = formatted_batches.Pop())
+    {
+        _output.write(batch->output.data(), static_cast<std::streamsize>(batch->output_size));
+
+        statistics.pairs += batch->sums.size();
+        statistics.input_bytes += batch->input_size;
+        statistics.output_bytes += batch->output_size;
+        free_batches.Push(batch);
+    }
+
+    reader.join();
+    parser.join();
+    adder.join();
+    formatter.join();
+
+    return statistics;
+}
+#endif
+
 void Add()
 {
     IO& io = IO::GetInstance(INPUT_FILE_NAME, OUTPUT_FILE_NAME);
@@ -366,6 +1070,84 @@ void Add_Legacy()
     fprintf(io.OUT, "%d\n", a + b);
 }
 
+#ifdef BIG_NUMBERS
+// Adds two numbers of any number of digits.
+void Add_Big_Numbers()
+{
+    IO& io = IO::GetInstance(INPUT_FILE_NAME, OUTPUT_FILE_NAME);
+
+    const std::vector<char> text = read_file(io.IN);
+    #ifdef PROFILING
+    const auto fast_begin = std::chrono::steady_clock::now();
+    #endif
+
+    const char*       position = text.data();
+    const char* const end      = text.data() + text.size();
+    Big_Number        a        = parse_big_number(position, end);
+    Big_Number        b        = parse_big_number(position, end);
+
+    std::vector<char> output;
+    write_big_number(add_big_numbers(std::move(a), std::move(b)), output);
+    output.push_back('\n');
+
+    #ifdef PROFILING
+    const std::chrono::duration<double> fast_time = std::chrono::steady_clock::now() - fast_begin;
+
+    // The same digits through the naive adder, signs left out.
+    std::string digits[2];
+    position = text.data();
+    for (std::string& number : digits)
+    {
+        while (position != end && is_digit(*position) == false)
+        {
+            position++;
+        }
+        const char* const digits_end = skip_digits(position, end);
+        number.assign(position, digits_end);
+        position = digits_end;
+    }
+
+    const auto                          naive_begin = std::chrono::steady_clock::now();
+    const std::string                   naive_sum   = add_digits_naive(digits[0], digits[1]);
+    const std::chrono::duration<double> naive_time  = std::chrono::steady_clock::now() - naive_begin;
+
+    const double digits_count = static_cast<double>(digits[0].size() + digits[1].size());
+    std::cout << digits_count << " digits | base 10^8 limbs: " << digits_count / fast_time.count()
+              << " digits/s | naive: " << digits_count / naive_time.count() << " digits/s ("
+              << naive_sum.size() << " digits)\n";
+    #endif
+
+    io.OUT.write(output.data(), static_cast<std::streamsize>(output.size()));
+}
+#endif
+
+#ifdef BULK_INPUT
+// Adds up every "a b" line of the input, one sum per line.
+void Add_Bulk()
+{
+    IO& io = IO::GetInstance(INPUT_FILE_NAME, OUTPUT_FILE_NAME);
+
+    #ifdef PROFILING
+    const auto begin = std::chrono::steady_clock::now();
+    #endif
+
+    const Pipeline_Statistics statistics = add_pairs_in_pipeline(io.IN, io.OUT);
+    io.OUT.flush();
+
+    #ifdef PROFILING
+    const std::chrono::duration<double> time      = std::chrono::steady_clock::now() - begin;
+    const double                        input_gb  = static_cast<double>(statistics.input_bytes) / 1e9;
+    const double                        output_gb = static_cast<double>(statistics.output_bytes) / 1e9;
+    std::cout << statistics.pairs << " pairs | "
+              << input_gb << " GB in, " << output_gb << " GB out | "
+              << input_gb / time.count() << " GB/s in, "
+              << (input_gb + output_gb) / time.count() << " GB/s in + out\n";
+    #else
+    static_cast<void>(statistics);
+    #endif
+}
+#endif
+
 bool randomBoolean()
 {
     static std::default_random_engine generator(std::random_device{}());
@@ -380,10 +1162,18 @@ int main()
     Profiling profiling = Profiling(__PRETTY_FUNCTION__, "Add two numbers from a file.");
     #endif
 
+    #if defined(BULK_INPUT)
+    // -DBULK_INPUT: any number of "a b" lines, through a pipeline of threads.
+    Add_Bulk();
+    #elif defined(BIG_NUMBERS)
+    // -DBIG_NUMBERS: the numbers can have any number of digits.
+    Add_Big_Numbers();
+    #else
     if (randomBoolean())
         Add();
     else
         Add_Legacy();
+    #endif
 
     #ifdef PROFILING
     profiling.End_Profiling();
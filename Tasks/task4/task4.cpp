@@ -4,6 +4,17 @@
 #include <iostream>
 #include <unordered_map>
 
+#ifdef BIG_NUMBERS
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#endif
+
 #ifdef PROFILING
 #include <chrono>
 #endif
@@ -210,17 +221,416 @@ class Profiling
 };
 #endif
 
+#ifdef BIG_NUMBERS
+// Reads the whole stream into one buffer, in one go.
+std::vector<char> read_file(std::istream& _input)
+{
+    _input.seekg(0, std::ios::end);
+    const std::streamoff file_size = _input.tellg();
+    _input.seekg(0, std::ios::beg);
+
+    std::vector<char> contents(static_cast<std::size_t>(file_size > 0 ? file_size : 0));
+    _input.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+
+    return contents;
+}
+
+/* Big numbers are kept in base 10^8: 8 decimal digits to a 32-bit limb, the least significant limb first.
+ * 16 digits make two limbs, so one 16-byte SSE2 load parses into two limbs;
+ * and a sum of two limbs (< 2 * 10^8) still fits a signed 32-bit lane, for SSE2's signed compares.
+ */
+constexpr std::size_t   LIMB_DIGITS = 8;
+constexpr std::uint32_t LIMB_BASE   = 100'000'000;
+
+struct Big_Number
+{
+    bool                       negative = false;
+    std::vector<std::uint32_t> limbs; // without leading zero limbs, so zero has none
+};
+
+// Whitespace as the "C" locale's isspace sees it: ' ', '\t', '\n', '\v', '\f', '\r'.
+inline bool is_space(const char _character)
+{
+    return _character == ' ' || static_cast<unsigned char>(_character - '\t') <= '\r' - '\t';
+}
+
+inline bool is_digit(const char _character)
+{
+    return static_cast<unsigned char>(_character - '0') <= 9;
+}
+
+// First position in [_from, _end) that is not a digit.
+const char* skip_digits(const char* _from, const char* const _end)
+{
+    #ifdef __SSE2__
+    for (; _from + 16 <= _end; _from += 16)
+    {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_from));
+        // c - '0' <= 9, as a signed compare after moving '0' to -128.
+        const __m128i shifted = _mm_add_epi8(bytes, _mm_set1_epi8(static_cast<char>(0x80 - '0')));
+        const unsigned int digits = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmplt_epi8(shifted, _mm_set1_epi8(-128 + 10))));
+        if (digits != 0xFFFF)
+        {
+            return _from + __builtin_ctz(~digits);
+        }
+    }
+    #endif
+
+    while (_from != _end && is_digit(*_from))
+    {
+        _from++;
+    }
+
+    return _from;
+}
+
+// The value of _count (at most LIMB_DIGITS) digits.
+std::uint32_t parse_limb(const char* const _digits, const std::size_t _count)
+{
+    std::uint32_t limb = 0;
+    for (std::size_t digit = 0; digit < _count; digit++)
+    {
+        limb = limb * 10 + static_cast<std::uint32_t>(_digits[digit] - '0');
+    }
+
+    return limb;
+}
+
+/* The two limbs that 16 digits make: _high from the first 8, _low from the last 8.
+ * With SSE2, neighbours are paired up by multiply-adds: digits into 2-digit numbers (x 10),
+ * then 4-digit ones (x 100), then 8-digit ones (x 10'000), each step fitting 16-bit inputs.
+ */
+inline void parse_two_limbs(const char* const _digits, std::uint32_t& _high, std::uint32_t& _low)
+{
+    #ifdef __SSE2__
+    const __m128i digits = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_digits)), _mm_set1_epi8('0'));
+    const __m128i zero   = _mm_setzero_si128();
+
+    const __m128i tens = _mm_set1_epi32(10 | (1 << 16));
+    const __m128i pairs = _mm_packs_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(digits, zero), tens),
+                                          _mm_madd_epi16(_mm_unpackhi_epi8(digits, zero), tens));
+    const __m128i quads  = _mm_madd_epi16(pairs, _mm_set1_epi32(100 | (1 << 16)));
+    const __m128i eights = _mm_madd_epi16(_mm_packs_epi32(quads, quads), _mm_set1_epi32(10'000 | (1 << 16)));
+
+    _high = static_cast<std::uint32_t>(_mm_cvtsi128_si32(eights));
+    _low  = static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(eights, 4)));
+    #else
+    _high = parse_limb(_digits, LIMB_DIGITS);
+    _low  = parse_limb(_digits + LIMB_DIGITS, LIMB_DIGITS);
+    #endif
+}
+
+// Parses the number at _position, an optional sign and then digits, and moves _position past it.
+Big_Number parse_big_number(const char*& _position, const char* const _end)
+{
+    while (_position != _end && is_space(*_position))
+    {
+        _position++;
+    }
+
+    Big_Number number;
+    if (_position != _end && (*_position == '-' || *_position == '+'))
+    {
+        number.negative = *_position == '-';
+        _position++;
+    }
+
+    const char* begin = _position;
+    _position         = skip_digits(_position, _end);
+    while (begin != _position && *begin == '0')
+    {
+        begin++;
+    }
+
+    // Limbs come out most significant first, from the front of the digits: the first one takes what is left over
+    // from whole limbs, then two limbs at a time.
+    const std::size_t digits_count = static_cast<std::size_t>(_position - begin);
+    // One spare limb, so that a carry out of an addition does not move all the others.
+    number.limbs.reserve((digits_count + LIMB_DIGITS - 1) / LIMB_DIGITS + 1);
+    number.limbs.resize((digits_count + LIMB_DIGITS - 1) / LIMB_DIGITS);
+    std::size_t limb = number.limbs.size();
+
+    const std::size_t head = digits_count % LIMB_DIGITS;
+    if (head)
+    {
+        number.limbs[--limb] = parse_limb(begin, head);
+        begin += head;
+    }
+
+    if (limb % 2)
+    {
+        number.limbs[--limb] = parse_limb(begin, LIMB_DIGITS);
+        begin += LIMB_DIGITS;
+    }
+
+    for (; limb; limb -= 2, begin += 2 * LIMB_DIGITS)
+    {
+        parse_two_limbs(begin, number.limbs[limb - 1], number.limbs[limb - 2]);
+    }
+
+    if (number.limbs.empty())
+    {
+        number.negative = false;
+    }
+
+    return number;
+}
+
+// -1, 0 or 1, as |_a| is less than, equal to or greater than |_b|.
+int compare_magnitudes(const Big_Number& _a, const Big_Number& _b)
+{
+    if (_a.limbs.size() != _b.limbs.size())
+    {
+        return _a.limbs.size() < _b.limbs.size() ? -1 : 1;
+    }
+
+    for (std::size_t limb = _a.limbs.size(); limb--;)
+    {
+        if (_a.limbs[limb] != _b.limbs[limb])
+        {
+            return _a.limbs[limb] < _b.limbs[limb] ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+#ifdef __SSE2__
+/* Adds 16 limbs of _addend into _sum, with _carry in and out.
+ * Carries are found for all 16 limbs at once, as in a carry-lookahead adder: limb i generates a carry
+ * if a + b >= LIMB_BASE, and passes one on if a + b == LIMB_BASE - 1. With those as bit masks G and P,
+ * the carries into the limbs are ((G << 1 | carry in) + P) ^ P: the addition runs each carry up through
+ * a run of propagating limbs, and the bit it leaves past the last limb is the carry out.
+ */
+inline void add_limbs_block(std::uint32_t* const _sum, const std::uint32_t* const _addend, unsigned int& _carry)
+{
+    const __m128i top  = _mm_set1_epi32(static_cast<int>(LIMB_BASE - 1));
+    const __m128i base = _mm_set1_epi32(static_cast<int>(LIMB_BASE));
+
+    __m128i      sums[4];
+    unsigned int generate  = 0;
+    unsigned int propagate = 0;
+    for (unsigned int vector = 0; vector < 4; vector++)
+    {
+        sums[vector] = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_sum + 4 * vector)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(_addend + 4 * vector)));
+        generate  |= static_cast<unsigned int>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(sums[vector], top)))) << (4 * vector);
+        propagate |= static_cast<unsigned int>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(sums[vector], top)))) << (4 * vector);
+    }
+
+    const unsigned int carries = (((generate << 1) | _carry) + propagate) ^ propagate;
+    _carry                     = (carries >> 16) & 1;
+
+    const __m128i lane_bits = _mm_setr_epi32(1, 2, 4, 8);
+    for (unsigned int vector = 0; vector < 4; vector++)
+    {
+        // All ones in the lanes that take a carry: subtracting -1 adds it.
+        const __m128i carry_lanes = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(static_cast<int>(carries >> (4 * vector))), lane_bits), lane_bits);
+        const __m128i sum         = _mm_sub_epi32(sums[vector], carry_lanes);
+        const __m128i wrapped     = _mm_sub_epi32(sum, _mm_and_si128(_mm_cmpgt_epi32(sum, top), base));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(_sum + 4 * vector), wrapped);
+    }
+}
+#endif
+
+// |_sum| += |_addend|.
+void add_magnitudes(Big_Number& _sum, const Big_Number& _addend)
+{
+    if (_sum.limbs.size() < _addend.limbs.size())
+    {
+        _sum.limbs.resize(_addend.limbs.size(), 0);
+    }
+
+    std::uint32_t* const       sum    = _sum.limbs.data();
+    const std::uint32_t* const addend = _addend.limbs.data();
+    const std::size_t          count  = _addend.limbs.size();
+    unsigned int               carry  = 0;
+    std::size_t                limb   = 0;
+
+    #ifdef __SSE2__
+    for (; limb + 16 <= count; limb += 16)
+    {
+        add_limbs_block(sum + limb, addend + limb, carry);
+    }
+    #endif
+
+    for (; limb < count || (carry && limb < _sum.limbs.size()); limb++)
+    {
+        const std::uint32_t value = sum[limb] + (limb < count ? addend[limb] : 0) + carry;
+        carry                     = value >= LIMB_BASE;
+        sum[limb]                 = carry ? value - LIMB_BASE : value;
+    }
+
+    if (carry)
+    {
+        _sum.limbs.push_back(1);
+    }
+}
+
+// |_difference| -= |_subtrahend|, where |_subtrahend| <= |_difference|.
+void subtract_magnitudes(Big_Number& _difference, const Big_Number& _subtrahend)
+{
+    std::uint32_t borrow = 0;
+    for (std::size_t limb = 0; limb < _subtrahend.limbs.size() || borrow; limb++)
+    {
+        const std::uint32_t taken = (limb < _subtrahend.limbs.size() ? _subtrahend.limbs[limb] : 0) + borrow;
+        borrow                    = _difference.limbs[limb] < taken;
+        _difference.limbs[limb]   = _difference.limbs[limb] + (borrow ? LIMB_BASE : 0) - taken;
+    }
+
+    while (_difference.limbs.empty() == false && _difference.limbs.back() == 0)
+    {
+        _difference.limbs.pop_back();
+    }
+}
+
+Big_Number add_big_numbers(Big_Number _a, Big_Number _b)
+{
+    if (_a.negative == _b.negative)
+    {
+        add_magnitudes(_a, _b);
+        return _a;
+    }
+
+    // Opposite signs: the smaller magnitude comes off the larger one, which keeps its sign.
+    if (compare_magnitudes(_a, _b) < 0)
+    {
+        std::swap(_a, _b);
+    }
+    subtract_magnitudes(_a, _b);
+    if (_a.limbs.empty())
+    {
+        _a.negative = false;
+    }
+
+    return _a;
+}
+
+constexpr char DIGIT_PAIRS[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+                               "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+                               "8081828384858687888990919293949596979899";
+
+// Writes the 8 digits of _limb, leading zeros included, two digits at a time.
+inline void write_limb(std::uint32_t _limb, char* const _output)
+{
+    for (std::size_t pair = LIMB_DIGITS / 2; pair--; _limb /= 100)
+    {
+        std::memcpy(_output + 2 * pair, DIGIT_PAIRS + 2 * (_limb % 100), 2);
+    }
+}
+
+// Appends _number in decimal to _output, with one buffer resize and no per-digit stream calls.
+void write_big_number(const Big_Number& _number, std::vector<char>& _output)
+{
+    if (_number.limbs.empty())
+    {
+        _output.push_back('0');
+        return;
+    }
+
+    if (_number.negative)
+    {
+        _output.push_back('-');
+    }
+
+    // The most significant limb has no leading zeros.
+    char top[LIMB_DIGITS];
+    write_limb(_number.limbs.back(), top);
+    const char* const top_end   = top + LIMB_DIGITS;
+    const char*       top_begin = top;
+    while (top_begin + 1 != top_end && *top_begin == '0')
+    {
+        top_begin++;
+    }
+    _output.insert(_output.end(), top_begin, top_end);
+
+    std::size_t position = _output.size();
+    _output.resize(position + (_number.limbs.size() - 1) * LIMB_DIGITS);
+    for (std::size_t limb = _number.limbs.size() - 1; limb--; position += LIMB_DIGITS)
+    {
+        write_limb(_number.limbs[limb], _output.data() + position);
+    }
+}
+
+#ifdef PROFILING
+// The reference to measure against: schoolbook addition of two digit strings, one character at a time.
+std::string add_digits_naive(const std::string& _a, const std::string& _b)
+{
+    std::string sum;
+    int         carry = 0;
+    for (std::size_t digit = 0; digit < std::max(_a.size(), _b.size()) || carry; digit++)
+    {
+        const int value = carry + (digit < _a.size() ? _a[_a.size() - 1 - digit] - '0' : 0) +
+                          (digit < _b.size() ? _b[_b.size() - 1 - digit] - '0' : 0);
+        sum.push_back(static_cast<char>('0' + value % 10));
+        carry = value / 10;
+    }
+    std::reverse(sum.begin(), sum.end());
+
+    return sum;
+}
+#endif
+#endif
+
 int main()
 {
     #ifdef PROFILING
     Profiling profiling = Profiling(__PRETTY_FUNCTION__);
     #endif
 
+    #ifdef BIG_NUMBERS
+    // -DBIG_NUMBERS: the numbers can have any number of digits.
+    IO& io = IO::GetInstance(INPUT_FILE_NAME, OUTPUT_FILE_NAME);
+
+    const std::vector<char> text = read_file(io.IN);
+    #ifdef PROFILING
+    const auto fast_begin = std::chrono::steady_clock::now();
+    #endif
+
+    const char*       position = text.data();
+    const char* const end      = text.data() + text.size();
+    Big_Number        a        = parse_big_number(position, end);
+    Big_Number        b        = parse_big_number(position, end);
+
+    std::vector<char> output;
+    write_big_number(add_big_numbers(std::move(a), std::move(b)), output);
+    output.push_back('\n');
+
+    #ifdef PROFILING
+    const std::chrono::duration<double> fast_time = std::chrono::steady_clock::now() - fast_begin;
+
+    // The same digits through the naive adder, signs left out.
+    std::string digits[2];
+    position = text.data();
+    for (std::string& number : digits)
+    {
+        while (position != end && is_digit(*position) == false)
+        {
+            position++;
+        }
+        const char* const digits_end = skip_digits(position, end);
+        number.assign(position, digits_end);
+        position = digits_end;
+    }
+
+    const auto                          naive_begin = std::chrono::steady_clock::now();
+    const std::string                   naive_sum   = add_digits_naive(digits[0], digits[1]);
+    const std::chrono::duration<double> naive_time  = std::chrono::steady_clock::now() - naive_begin;
+
+    const double digits_count = static_cast<double>(digits[0].size() + digits[1].size());
+    std::cout << digits_count << " digits | base 10^8 limbs: " << digits_count / fast_time.count()
+              << " digits/s | naive: " << digits_count / naive_time.count() << " digits/s ("
+              << naive_sum.size() << " digits)\n";
+    #endif
+
+    io.OUT.write(output.data(), static_cast<std::streamsize>(output.size()));
+    #else
     IO& io = IO::GetInstance(INPUT_FILE_NAME, OUTPUT_FILE_NAME);
 
     int a, b;
     io.IN >> a >> b;
     io.OUT << a + b << std::endl;
+    #endif
 
     #ifdef PROFILING
     profiling.End_Profiling();
@@ -1,9 +1,30 @@
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <fstream>
 #include <iostream>
-#include <sstream>
 #include <unordered_map>
+#include <vector>
+
+#ifdef PARALLEL_INPUT
+#include <algorithm>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #ifdef PROFILING
 #include <chrono>
@@ -211,41 +232,613 @@ class Profiling
 };
 #endif
 
-int main()
+// Reads the whole stream into one buffer, in one go.
+std::vector<char> read_file(std::istream& _input)
 {
-    #ifdef PROFILING
-    Profiling profiling = Profiling(__PRETTY_FUNCTION__);
-    #endif
+    _input.seekg(0, std::ios::end);
+    const std::streamoff file_size = _input.tellg();
+    _input.seekg(0, std::ios::beg);
 
-    IO& io = IO::GetInstance(INPUT_FILE_NAME, OUTPUT_FILE_NAME);
+    std::vector<char> contents(static_cast<std::size_t>(file_size > 0 ? file_size : 0));
+    _input.read(contents.data(), static_cast<std::streamsize>(contents.size()));
 
-    // Read the entire file into a buffer.
-    std::ostringstream buffer;
-    buffer << io.IN.rdbuf();
-    // Convert the buffer into a string.
-    std::string contents(buffer.str());
-
-    unsigned int long long word_count   = 0;
-    unsigned int long long letter_count = 0;
-    bool                   valid_word   = false;
-    for (const char& c : contents)
+    return contents;
+}
+
+/* UTF-8 letter classification.
+ * ASCII letters are the "C" locale's isalpha letters. Beyond ASCII, LETTER_RANGES lists the code points
+ * of Unicode general category L below U+0800, which covers Latin (Romanian ă â î ș ț included),
+ * Greek, Cyrillic, Armenian, Hebrew, Arabic, Syriac and Thaana: everything UTF-8 writes in two bytes.
+ * Three- and four-byte characters count as non-letters. Malformed bytes are non-letters, one byte at a time.
+ */
+constexpr char32_t LETTER_RANGES[][2] = {
+    {0x0041, 0x005A}, {0x0061, 0x007A}, {0x00AA, 0x00AA}, {0x00B5, 0x00B5}, {0x00BA, 0x00BA}, {0x00C0, 0x00D6},
+    {0x00D8, 0x00F6}, {0x00F8, 0x02C1}, {0x02C6, 0x02D1}, {0x02E0, 0x02E4}, {0x02EC, 0x02EC}, {0x02EE, 0x02EE},
+    {0x0370, 0x0374}, {0x0376, 0x0377}, {0x037A, 0x037D}, {0x037F, 0x037F}, {0x0386, 0x0386}, {0x0388, 0x038A},
+    {0x038C, 0x038C}, {0x038E, 0x03A1}, {0x03A3, 0x03F5}, {0x03F7, 0x0481}, {0x048A, 0x052F}, {0x0531, 0x0556},
+    {0x0559, 0x0559}, {0x0560, 0x0588}, {0x05D0, 0x05EA}, {0x05EF, 0x05F2}, {0x0620, 0x064A}, {0x066E, 0x066F},
+    {0x0671, 0x06D3}, {0x06D5, 0x06D5}, {0x06E5, 0x06E6}, {0x06EE, 0x06EF}, {0x06FA, 0x06FC}, {0x06FF, 0x06FF},
+    {0x0710, 0x0710}, {0x0712, 0x072F}, {0x074D, 0x07A5}, {0x07B1, 0x07B1}, {0x07CA, 0x07EA}, {0x07F4, 0x07F5},
+    {0x07FA, 0x07FA}};
+
+constexpr char32_t TWO_BYTE_LIMIT = 0x800;
+
+// One bit per code point below TWO_BYTE_LIMIT, set for letters.
+struct Letter_Table
+{
+    std::uint64_t bits[TWO_BYTE_LIMIT / 64];
+
+    constexpr bool Is_Letter(const char32_t _code_point) const
     {
-        if (isalpha(c))
+        return (bits[_code_point / 64] >> (_code_point % 64)) & 1;
+    }
+};
+
+constexpr Letter_Table make_letter_table()
+{
+    Letter_Table table{};
+    for (const auto& range : LETTER_RANGES)
+    {
+        for (char32_t code_point = range[0]; code_point <= range[1]; code_point++)
+        {
+            table.bits[code_point / 64] |= std::uint64_t(1) << (code_point % 64);
+        }
+    }
+
+    return table;
+}
+
+constexpr Letter_Table LETTER_TABLE = make_letter_table();
+
+// Letters as the "C" locale's isalpha sees them, without the locale lookup.
+inline bool is_ascii_letter(const char _character)
+{
+    return static_cast<unsigned char>((_character | 0x20) - 'a') < 26;
+}
+
+inline bool is_continuation_byte(const char _character)
+{
+    return (static_cast<unsigned char>(_character) & 0xC0) == 0x80;
+}
+
+/* Decodes the character at _text (before _end) and returns whether it is a letter.
+ * _length receives its length in bytes: 1 for ASCII and for a malformed byte.
+ */
+inline bool decode_letter(const char* const _text, const char* const _end, std::size_t& _length)
+{
+    const unsigned char lead = static_cast<unsigned char>(_text[0]);
+    _length                  = 1;
+    if (lead < 0x80)
+    {
+        return is_ascii_letter(_text[0]);
+    }
+
+    // 110xxxxx: two bytes, the only lengths with letters in the table; C0 and C1 would be overlong.
+    if (lead >= 0xC2 && lead <= 0xDF)
+    {
+        if (_end - _text < 2 || is_continuation_byte(_text[1]) == false)
+        {
+            return false;
+        }
+
+        _length = 2;
+        return LETTER_TABLE.Is_Letter((char32_t(lead & 0x1F) << 6) | (static_cast<unsigned char>(_text[1]) & 0x3F));
+    }
+
+    // 1110xxxx and 11110xxx: skip over the whole character.
+    const std::size_t length = lead >= 0xE0 && lead <= 0xEF ? 3 : lead >= 0xF0 && lead <= 0xF4 ? 4 : 1;
+    if (length > 1 && _end - _text >= static_cast<std::ptrdiff_t>(length))
+    {
+        bool well_formed = true;
+        for (std::size_t i = 1; i < length; i++)
+        {
+            well_formed &= is_continuation_byte(_text[i]);
+        }
+        _length = well_formed ? length : 1;
+    }
+
+    return false;
+}
+
+// Whether the character that ends just before _end (and starts no earlier than _begin) is a letter.
+inline bool last_is_letter(const char* const _begin, const char* const _end)
+{
+    const char* start = _end - 1;
+    while (start > _begin && _end - start < 4 && is_continuation_byte(*start))
+    {
+        start--;
+    }
+
+    std::size_t length = 0;
+    const bool  letter = decode_letter(start, _end, length);
+    return letter && start + length == _end;
+}
+
+inline unsigned int popcount(const std::uint32_t _mask)
+{
+    #ifdef __POPCNT__
+    return static_cast<unsigned int>(__builtin_popcount(_mask));
+    #else
+    // Without the POPCNT instruction GCC would call a library function; this stays inline.
+    std::uint32_t count = _mask - ((_mask >> 1) & 0x55555555);
+    count               = (count & 0x33333333) + ((count >> 2) & 0x33333333);
+    count               = (count + (count >> 4)) & 0x0F0F0F0F;
+    return (count * 0x01010101) >> 24;
+    #endif
+}
+
+/* Letter_Counter: counts letters and words (runs of letters) in UTF-8 text fed to it in pieces.
+ * Pieces must not split a character.
+ * Blocks of 32 bytes are classified at once into bit masks (one AVX2 or two SSE2 compares):
+ * the ASCII letters, and the bytes that are not ASCII. A block with no non-ASCII bytes is done
+ * with those masks alone. Otherwise only its non-ASCII characters are decoded one by one,
+ * and each letter's bytes are added to the mask, so the cost grows with the diacritics, not the text.
+ * A letter is counted at its first byte; the words are the letter bytes whose previous byte is not one,
+ * with the last byte of one block carried in as the previous byte of the next.
+ * Without AVX2, runs of pure ASCII go through Count_Ascii first: popcount is not part of SSE2,
+ * so there the masks are summed in byte counters instead, and the 32-byte blocks only take what is not ASCII.
+ * A scalar loop takes the tail.
+ */
+class Letter_Counter
+{
+    private:
+        unsigned long long letters         = 0;
+        unsigned long long words           = 0;
+        bool               previous_letter = false;
+
+        #if defined(__AVX2__) || defined(__SSE2__)
+        static constexpr std::size_t BLOCK_SIZE = 32;
+
+        struct Block_Masks
+        {
+            std::uint32_t ascii_letters; // bit i is set if _block[i] is an ASCII letter
+            std::uint32_t non_ascii;     // bit i is set if _block[i] ≥ 0x80
+        };
+
+        struct Utf8_Masks
+        {
+            std::uint32_t continuation;   // bit i is set if _block[i] is 10xxxxxx
+            std::uint32_t two_byte_leads; // bit i is set if _block[i] is C2..DF
+        };
+
+        /* (c | 0x20) - 'a' < 26, as a signed compare after moving 'a' to -128.
+         * Bytes ≥ 0x80 land outside the range, so they are never ASCII letters.
+         */
+        static Block_Masks Classify(const char* const _block)
+        {
+            #if defined(__AVX2__)
+            const __m256i bytes   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_block));
+            const __m256i shifted = _mm256_add_epi8(_mm256_or_si256(bytes, _mm256_set1_epi8(0x20)), _mm256_set1_epi8(0x80 - 'a'));
+            const __m256i letters = _mm256_cmpgt_epi8(_mm256_set1_epi8(-128 + 26), shifted);
+            return {static_cast<std::uint32_t>(_mm256_movemask_epi8(letters)), static_cast<std::uint32_t>(_mm256_movemask_epi8(bytes))};
+            #else
+            Block_Masks masks = {0, 0};
+            for (int half = 0; half < 2; half++)
+            {
+                const __m128i bytes   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_block + 16 * half));
+                const __m128i shifted = _mm_add_epi8(_mm_or_si128(bytes, _mm_set1_epi8(0x20)), _mm_set1_epi8(0x80 - 'a'));
+                const __m128i letters = _mm_cmplt_epi8(shifted, _mm_set1_epi8(-128 + 26));
+
+                masks.ascii_letters |= static_cast<std::uint32_t>(_mm_movemask_epi8(letters)) << (16 * half);
+                masks.non_ascii |= static_cast<std::uint32_t>(_mm_movemask_epi8(bytes)) << (16 * half);
+            }
+            return masks;
+            #endif
+        }
+
+        // As signed bytes, continuation bytes are [-128, -65] and two-byte leads [-62, -33].
+        static Utf8_Masks Classify_Utf8(const char* const _block)
+        {
+            #if defined(__AVX2__)
+            const __m256i bytes        = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_block));
+            const __m256i continuation = _mm256_cmpgt_epi8(_mm256_set1_epi8(-64), bytes);
+            const __m256i leads        = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, _mm256_set1_epi8(-63)),
+                                                          _mm256_cmpgt_epi8(_mm256_set1_epi8(-32), bytes));
+            return {static_cast<std::uint32_t>(_mm256_movemask_epi8(continuation)), static_cast<std::uint32_t>(_mm256_movemask_epi8(leads))};
+            #else
+            Utf8_Masks masks = {0, 0};
+            for (int half = 0; half < 2; half++)
+            {
+                const __m128i bytes        = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_block + 16 * half));
+                const __m128i continuation = _mm_cmplt_epi8(bytes, _mm_set1_epi8(-64));
+                const __m128i leads        = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(-63)), _mm_cmplt_epi8(bytes, _mm_set1_epi8(-32)));
+
+                masks.continuation |= static_cast<std::uint32_t>(_mm_movemask_epi8(continuation)) << (16 * half);
+                masks.two_byte_leads |= static_cast<std::uint32_t>(_mm_movemask_epi8(leads)) << (16 * half);
+            }
+            return masks;
+            #endif
+        }
+
+        /* One 32-byte block: its letters and words, with the non-ASCII characters decoded.
+         * _carried_bytes and _carried_letters are the bytes at the start of the next block that belong to
+         * a character begun in this one (and are letter bytes): they come in from the block before and go out to the next.
+         * Returns whether the block was all ASCII.
+         */
+        bool Count_Block(const char* const _block, const char* const _end, std::uint32_t& _carried_bytes, std::uint32_t& _carried_letters)
+        {
+            const Block_Masks masks = Classify(_block);
+
+            std::uint32_t mask = masks.ascii_letters | _carried_letters;
+            letters += popcount(masks.ascii_letters);
+
+            if (masks.non_ascii)
+            {
+                std::uint32_t pending = masks.non_ascii & ~_carried_bytes;
+                _carried_bytes        = 0;
+                _carried_letters      = 0;
+
+                // Well-formed two-byte characters inside the block, the usual non-ASCII case: no decoding branches.
+                const Utf8_Masks utf8_masks = Classify_Utf8(_block);
+                std::uint32_t    two_byte   = utf8_masks.two_byte_leads & (utf8_masks.continuation >> 1);
+                pending &= ~(two_byte | (two_byte << 1));
+                while (two_byte)
+                {
+                    const unsigned int  position   = static_cast<unsigned int>(__builtin_ctz(two_byte));
+                    const char32_t      code_point = (char32_t(_block[position] & 0x1F) << 6) | (_block[position + 1] & 0x3F);
+                    const std::uint32_t letter     = LETTER_TABLE.Is_Letter(code_point);
+
+                    letters += letter;
+                    mask |= (letter * 3u) << position;
+                    two_byte &= two_byte - 1;
+                }
+
+                // Anything else that is not ASCII, including characters that run into the next block.
+                while (pending)
+                {
+                    const unsigned int position = static_cast<unsigned int>(__builtin_ctz(pending));
+                    std::size_t        length   = 0;
+                    const bool         letter   = decode_letter(_block + position, _end, length);
+
+                    // The character's bytes, as a mask over this block and the next.
+                    const std::uint64_t bytes = ((std::uint64_t(1) << length) - 1) << position;
+                    pending &= ~static_cast<std::uint32_t>(bytes);
+                    _carried_bytes = static_cast<std::uint32_t>(bytes >> BLOCK_SIZE);
+                    if (letter)
+                    {
+                        letters++;
+                        mask |= static_cast<std::uint32_t>(bytes);
+                        _carried_letters = _carried_bytes;
+                    }
+                }
+            }
+
+            const std::uint32_t starts = mask & ~((mask << 1) | static_cast<std::uint32_t>(previous_letter));
+            words += popcount(starts);
+            previous_letter = mask >> (BLOCK_SIZE - 1);
+
+            return masks.non_ascii == 0;
+        }
+        #endif
+
+        #if !defined(__AVX2__) && defined(__SSE2__)
+        static constexpr std::size_t ASCII_STEP  = 16;
+        static constexpr std::size_t BLOCKS_SPAN = 255; // steps a byte counter can take without wrapping
+
+        // Byte i is 0xFF if byte i of _bytes is an ASCII letter, 0 otherwise.
+        static __m128i Letter_Bytes(const __m128i _bytes)
+        {
+            const __m128i shifted = _mm_add_epi8(_mm_or_si128(_bytes, _mm_set1_epi8(0x20)), _mm_set1_epi8(0x80 - 'a'));
+            return _mm_cmplt_epi8(shifted, _mm_set1_epi8(-128 + 26));
+        }
+
+        // Sum of the 16 byte counters.
+        static unsigned long long Sum_Bytes(const __m128i _counters)
+        {
+            const __m128i sums = _mm_sad_epu8(_counters, _mm_setzero_si128());
+            return static_cast<unsigned long long>(_mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+        }
+
+        /* Counts from _text in ASCII_STEP steps for as long as no byte is ≥ 0x80, and returns where it stopped.
+         * The letter and word-start byte masks are added up in byte counters, emptied every BLOCKS_SPAN steps.
+         */
+        const char* Count_Ascii(const char* _text, const char* const _end)
         {
-            letter_count++;
-            valid_word = true;
+            // Only the last byte of the previous step matters.
+            __m128i previous = previous_letter ? _mm_set1_epi8(-1) : _mm_setzero_si128();
+            bool    ascii    = true;
+            while (ascii && _text + ASCII_STEP <= _end)
+            {
+                __m128i letter_counters = _mm_setzero_si128();
+                __m128i start_counters  = _mm_setzero_si128();
+                for (std::size_t step = 0; step < BLOCKS_SPAN && _text + ASCII_STEP <= _end; step++, _text += ASCII_STEP)
+                {
+                    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_text));
+                    if (_mm_movemask_epi8(bytes))
+                    {
+                        ascii = false;
+                        break;
+                    }
+
+                    const __m128i current = Letter_Bytes(bytes);
+                    // Byte i of before is byte i - 1 of the text.
+                    const __m128i before = _mm_or_si128(_mm_slli_si128(current, 1), _mm_srli_si128(previous, 15));
+
+                    // Subtracting 0xFF (-1) adds one.
+                    letter_counters = _mm_sub_epi8(letter_counters, current);
+                    start_counters  = _mm_sub_epi8(start_counters, _mm_andnot_si128(before, current));
+                    previous        = current;
+                }
+
+                letters += Sum_Bytes(letter_counters);
+                words += Sum_Bytes(start_counters);
+            }
+            previous_letter = _mm_movemask_epi8(previous) >> (ASCII_STEP - 1);
+
+            return _text;
         }
-        else
+        #endif
+
+    public:
+        void Count(const char* _text, const std::size_t _size)
         {
-            if (valid_word)
+            const char* const end = _text + _size;
+
+            #if defined(__AVX2__) || defined(__SSE2__)
+            // Bytes at the start of the next block that belong to a character begun in this one.
+            std::uint32_t carried_bytes   = 0;
+            std::uint32_t carried_letters = 0;
+            #if !defined(__AVX2__)
+            bool ascii_block = true; // Count_Ascii is worth starting only after a block of ASCII
+            #endif
+            while (_text + BLOCK_SIZE <= end)
             {
-                word_count++;
-                valid_word = false;
+                #if !defined(__AVX2__)
+                if (ascii_block)
+                {
+                    _text = Count_Ascii(_text, end);
+                    if (_text + BLOCK_SIZE > end)
+                    {
+                        break;
+                    }
+                }
+
+                ascii_block = Count_Block(_text, end, carried_bytes, carried_letters);
+                #else
+                Count_Block(_text, end, carried_bytes, carried_letters);
+                #endif
+                _text += BLOCK_SIZE;
             }
+            // A character carried past the last block continues into the tail.
+            _text += popcount(carried_bytes);
+            #endif
+
+            while (_text != end)
+            {
+                std::size_t length = 0;
+                const bool  letter = decode_letter(_text, end, length);
+                letters += letter;
+                words += letter && previous_letter == false;
+                previous_letter = letter;
+                _text += length;
+            }
+        }
+
+        unsigned long long Letters() const
+        {
+            return letters;
+        }
+
+        unsigned long long Words() const
+        {
+            return words;
         }
+};
+
+#ifdef PARALLEL_INPUT
+// Chunks are at least this large, so small files are not split across threads for nothing.
+constexpr std::size_t MIN_CHUNK_SIZE = 1 << 20;
+
+/* Mapped_File: a read-only view of a whole file.
+ * With mmap nothing is read up front and the file can be larger than RAM;
+ * the threads fault their chunks in from the page cache in parallel.
+ * Elsewhere the file is read into a buffer instead.
+ */
+class Mapped_File
+{
+    private:
+        const char* data = nullptr;
+        std::size_t size = 0;
+        #ifndef HAS_MMAP
+        std::vector<char> buffer;
+        #endif
+
+        void PrintError(const char* const _file_name, const std::string& _error_source) const
+        {
+            std::cerr << _error_source << " file: " << _file_name << "\n"
+                    << "ERROR: " << strerror(errno) << std::endl;
+        }
+
+    public:
+        explicit Mapped_File(const char* const _file_name)
+        {
+            #ifdef HAS_MMAP
+            const int file_descriptor = open(_file_name, O_RDONLY);
+            if (file_descriptor < 0)
+            {
+                PrintError(_file_name, "Failed to open input");
+                assert(false);
+                return;
+            }
+
+            struct stat file_status;
+            if (fstat(file_descriptor, &file_status) == 0 && file_status.st_size > 0)
+            {
+                size = static_cast<std::size_t>(file_status.st_size);
+                void* const mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, file_descriptor, 0);
+                if (mapping == MAP_FAILED)
+                {
+                    PrintError(_file_name, "Failed to map input");
+                    size = 0;
+                    assert(false);
+                }
+                else
+                {
+                    // Every chunk is read front to back.
+                    madvise(mapping, size, MADV_SEQUENTIAL);
+                    data = static_cast<const char*>(mapping);
+                }
+            }
+
+            close(file_descriptor);
+            #else
+            std::ifstream file(_file_name, std::ios::binary);
+            if (!file.is_open())
+            {
+                PrintError(_file_name, "Failed to open input");
+                assert(false);
+                return;
+            }
+
+            buffer = read_file(file);
+            data   = buffer.data();
+            size   = buffer.size();
+            #endif
+        }
+
+        ~Mapped_File()
+        {
+            #ifdef HAS_MMAP
+            if (data)
+            {
+                munmap(const_cast<char*>(data), size);
+            }
+            #endif
+        }
+
+        Mapped_File(const Mapped_File&)            = delete;
+        Mapped_File& operator=(const Mapped_File&) = delete;
+
+        const char* Data() const
+        {
+            return data;
+        }
+
+        std::size_t Size() const
+        {
+            return size;
+        }
+};
+
+/* Text_Statistics: the counts of one chunk of text, plus what its edges look like.
+ * Two adjacent chunks combine by adding their counts, less the one word that was counted
+ * twice if the first chunk ends inside a word and the second starts inside it.
+ * Combining is associative, so chunks can be counted in any order and joined left to right.
+ */
+struct Text_Statistics
+{
+    unsigned long long bytes          = 0;
+    unsigned long long letters        = 0;
+    unsigned long long words          = 0;
+    bool               starts_in_word = false;
+    bool               ends_in_word   = false;
+
+    static Text_Statistics Of(const char* const _text, const std::size_t _size)
+    {
+        Letter_Counter counter;
+        counter.Count(_text, _size);
+
+        Text_Statistics statistics;
+        statistics.bytes          = _size;
+        statistics.letters        = counter.Letters();
+        statistics.words          = counter.Words();
+        std::size_t length        = 0;
+        statistics.starts_in_word = _size && decode_letter(_text, _text + _size, length);
+        statistics.ends_in_word   = _size && last_is_letter(_text, _text + _size);
+        return statistics;
+    }
+
+    // _left followed by _right.
+    static Text_Statistics Combine(const Text_Statistics& _left, const Text_Statistics& _right)
+    {
+        if (_left.bytes == 0)
+        {
+            return _right;
+        }
+        if (_right.bytes == 0)
+        {
+            return _left;
+        }
+
+        Text_Statistics combined;
+        combined.bytes          = _left.bytes + _right.bytes;
+        combined.letters        = _left.letters + _right.letters;
+        combined.words          = _left.words + _right.words - (_left.ends_in_word && _right.starts_in_word);
+        combined.starts_in_word = _left.starts_in_word;
+        combined.ends_in_word   = _right.ends_in_word;
+        return combined;
+    }
+};
+
+// Moves _position forward to the start of a character, so that no chunk splits one.
+std::size_t character_boundary(const char* const _text, const std::size_t _size, std::size_t _position)
+{
+    for (int step = 0; step < 3 && _position < _size && is_continuation_byte(_text[_position]); step++)
+    {
+        _position++;
     }
 
-    io.OUT << letter_count / word_count << std::endl;
+    return _position;
+}
+
+// Splits _text into one chunk per hardware thread, counts the chunks in parallel and stitches them together.
+Text_Statistics count_in_parallel(const char* const _text, const std::size_t _size)
+{
+    const std::size_t threads_count = std::max<std::size_t>(1, std::min<std::size_t>(std::thread::hardware_concurrency(),
+                                                                                      _size / MIN_CHUNK_SIZE));
+    const std::size_t chunk_size    = (_size + threads_count - 1) / threads_count;
+
+    std::vector<Text_Statistics> chunks(threads_count);
+    std::vector<std::thread>     threads;
+    threads.reserve(threads_count);
+    for (std::size_t chunk = 0; chunk < threads_count; chunk++)
+    {
+        const std::size_t begin = character_boundary(_text, _size, std::min(_size, chunk * chunk_size));
+        const std::size_t end   = character_boundary(_text, _size, std::min(_size, (chunk + 1) * chunk_size));
+        threads.emplace_back([&chunks, _text, chunk, begin, end]() {
+            chunks[chunk] = Text_Statistics::Of(_text + begin, end - begin);
+        });
+    }
+
+    Text_Statistics total;
+    for (std::size_t chunk = 0; chunk < threads_count; chunk++)
+    {
+        threads[chunk].join();
+        total = Text_Statistics::Combine(total, chunks[chunk]);
+    }
+
+    return total;
+}
+#endif
+
+int main()
+{
+    #ifdef PROFILING
+    Profiling profiling = Profiling(__PRETTY_FUNCTION__);
+    #endif
+
+    IO& io = IO::GetInstance(INPUT_FILE_NAME, OUTPUT_FILE_NAME);
+
+    #ifdef PARALLEL_INPUT
+    // -DPARALLEL_INPUT: the file is mapped and counted in chunks, one per hardware thread.
+    const Mapped_File     contents(INPUT_FILE_NAME);
+    const Text_Statistics statistics = count_in_parallel(contents.Data(), contents.Size());
+
+    const unsigned int long long word_count   = statistics.words;
+    const unsigned int long long letter_count = statistics.letters;
+    #else
+    // Read the entire file into a buffer.
+    const std::vector<char> contents = read_file(io.IN);
+
+    // A word is a run of letters; this also counts a word that runs up to the end of the file.
+    Letter_Counter counter;
+    counter.Count(contents.data(), contents.size());
+
+    const unsigned int long long word_count   = counter.Words();
+    const unsigned int long long letter_count = counter.Letters();
+    #endif
+
+    io.OUT << (word_count ? letter_count / word_count : 0) << std::endl;
 
     #ifdef PROFILING
     profiling.End_Profiling();
@@ -1,14 +1,21 @@
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <cstring>
 #include <fstream>
 #include <iostream>
-#include <map>
-#include <memory>
-#include <sstream>
-#include <stack>
 #include <unordered_map>
 #include <vector>
 
+#ifdef PARALLEL_CHAIN
+#include <atomic>
+#include <thread>
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #ifdef PROFILING
 #include <chrono>
 #endif
@@ -215,252 +222,844 @@ class Profiling
 };
 #endif
 
-class Node
+/* The Romanian alphabet: a-z, then ă â î ș ț, which UTF-8 writes in two bytes.
+ * Letters match case-sensitively, as in the original solution: "are" does not chain into "Eva",
+ * so the upper case forms are letters of their own. ș/ş and ț/ţ (the comma and cedilla forms) share a letter.
+ * With CASE_INSENSITIVE, upper and lower case share a letter too.
+ */
+#ifdef CASE_INSENSITIVE
+constexpr unsigned int ALPHABET_SIZE = 31;
+constexpr unsigned int LOWER_CASE    = 0;
+#else
+// Lower case comes after upper case, as in ASCII, so the later letter still wins ties between chains.
+constexpr unsigned int ALPHABET_SIZE = 62;
+constexpr unsigned int LOWER_CASE    = 31; // Offset of a lower case letter from its upper case form.
+#endif
+constexpr std::uint32_t NO_WORD = UINT32_MAX;
+
+struct Diacritic
+{
+    char32_t     code_point;
+    unsigned int index;
+};
+
+constexpr Diacritic DIACRITICS[] = {
+    {0x0102, 26}, {0x0103, 26 + LOWER_CASE}, // Ă ă
+    {0x00C2, 27}, {0x00E2, 27 + LOWER_CASE}, // Â â
+    {0x00CE, 28}, {0x00EE, 28 + LOWER_CASE}, // Î î
+    {0x0218, 29}, {0x0219, 29 + LOWER_CASE}, {0x015E, 29}, {0x015F, 29 + LOWER_CASE}, // Ș ș Ş ş
+    {0x021A, 30}, {0x021B, 30 + LOWER_CASE}, {0x0162, 30}, {0x0163, 30 + LOWER_CASE}  // Ț ț Ţ ţ
+};
+
+// Maps a code point to [0, ALPHABET_SIZE), or returns ALPHABET_SIZE if it is not a letter.
+unsigned int letter_index(const char32_t _code_point)
+{
+    if (_code_point < 0x80)
+    {
+        const unsigned int upper_index = _code_point - 'A';
+        const unsigned int lower_index = _code_point - 'a';
+        return upper_index < 26 ? upper_index : lower_index < 26 ? lower_index + LOWER_CASE : ALPHABET_SIZE;
+    }
+
+    for (const Diacritic& diacritic : DIACRITICS)
+    {
+        if (diacritic.code_point == _code_point)
+        {
+            return diacritic.index;
+        }
+    }
+
+    return ALPHABET_SIZE;
+}
+
+// The letter a word starts with. The ASCII case needs no decoding.
+unsigned int first_letter_index(const char* const _word, const std::size_t _length)
 {
+    const unsigned char lead = static_cast<unsigned char>(_word[0]);
+    if (lead < 0x80)
+    {
+        return letter_index(lead);
+    }
+
+    // Every letter past ASCII is two bytes long: 110xxxxx 10xxxxxx.
+    if ((lead & 0xE0) != 0xC0 || _length < 2 || (static_cast<unsigned char>(_word[1]) & 0xC0) != 0x80)
+    {
+        return ALPHABET_SIZE;
+    }
+
+    return letter_index((char32_t(lead & 0x1F) << 6) | (static_cast<unsigned char>(_word[1]) & 0x3F));
+}
+
+// The letter a word ends with.
+unsigned int last_letter_index(const char* const _word, const std::size_t _length)
+{
+    const unsigned char last = static_cast<unsigned char>(_word[_length - 1]);
+    if (last < 0x80)
+    {
+        return letter_index(last);
+    }
+
+    return _length >= 2 ? first_letter_index(_word + _length - 2, 2) : ALPHABET_SIZE;
+}
+
+// Reads the whole stream into one buffer, in one go.
+std::vector<char> read_file(std::istream& _input)
+{
+    _input.seekg(0, std::ios::end);
+    const std::streamoff file_size = _input.tellg();
+    _input.seekg(0, std::ios::beg);
+
+    std::vector<char> contents(static_cast<std::size_t>(file_size > 0 ? file_size : 0));
+    _input.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+
+    return contents;
+}
+
+/* String_View: a non-owning slice of a buffer (std::string_view is C++17).
+ * Tokens are handed out as views, so tokenising never copies or allocates.
+ */
+struct String_View
+{
+    const char* data = nullptr;
+    std::size_t size = 0;
+};
+
+// Whitespace as the "C" locale's isspace sees it: ' ', '\t', '\n', '\v', '\f', '\r'.
+inline bool is_space(const char _character)
+{
+    return _character == ' ' || static_cast<unsigned char>(_character - '\t') <= '\r' - '\t';
+}
+
+#ifdef __SSE2__
+// Bit i is set if _block[i] is whitespace.
+inline unsigned int space_mask(const char* const _block)
+{
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_block));
+    // c - '\t' <= '\r' - '\t', as a signed compare after moving '\t' to -128.
+    const __m128i shifted = _mm_add_epi8(bytes, _mm_set1_epi8(0x80 - '\t'));
+    const __m128i control = _mm_cmplt_epi8(shifted, _mm_set1_epi8(-128 + ('\r' - '\t' + 1)));
+    return static_cast<unsigned int>(_mm_movemask_epi8(_mm_or_si128(control, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')))));
+}
+#endif
+
+/* First position in [_from, _end) that is whitespace (_space) or is not (!_space).
+ * Tests 16 bytes at a time with SSE2, which every x86-64 has;
+ * words are a few bytes long, so wider vectors would rarely get to finish a block.
+ */
+const char* find_space(const char* _from, const char* const _end, const bool _space)
+{
+    #ifdef __SSE2__
+    for (; _from + 16 <= _end; _from += 16)
+    {
+        const unsigned int mask = _space ? space_mask(_from) : ~space_mask(_from) & 0xFFFF;
+        if (mask)
+        {
+            return _from + __builtin_ctz(mask);
+        }
+    }
+    #endif
+
+    while (_from != _end && is_space(*_from) != _space)
+    {
+        _from++;
+    }
+
+    return _from;
+}
+
+// Tokenizer: splits a buffer into whitespace-separated words.
+class Tokenizer
+{
+    private:
+        const char*       position;
+        const char* const end;
+
     public:
-        std::string&       word;
-        Node*              parent;
-        const unsigned int depth;
-
-        /* std::map<char, Node*> children: holds the children of the node.
-         * The key is the last letter of the word.
-         * The value is the child node.
-         * Whilst map is slower at adding objects than unordered_map,
-         * the map has 26 elements at most, so the difference is negligible.
-         * Also map is faster for seek/find.
-         */
-        std::map<char, Node*> children;
+        Tokenizer(const char* const _begin, const char* const _end) : position(_begin), end(_end) {}
 
-        explicit Node(std::string& _word, Node* _parent = nullptr)
-            : word(_word), parent(_parent), depth(_parent ? (_parent->depth + 1) : 1)
+        // Moves to the next word; returns false when there is none left.
+        bool Next_Word(String_View& _word)
         {
+            const char* const begin = find_space(position, end, false);
+            if (begin == end)
+            {
+                position = end;
+                return false;
+            }
+
+            position = find_space(begin, end, true);
+            _word    = {begin, static_cast<std::size_t>(position - begin)};
+            return true;
         }
+};
 
-        ~Node() = default;
+/* Word_Span: a word as a slice of the input text, so no word owns an allocation.
+ * Words are identified by their 32-bit position in the input.
+ */
+struct Word_Span
+{
+    std::uint32_t begin;
+    std::uint32_t length;
+};
 
-        bool Is_Root() const
+/* Chain_Table: per-letter DP for the longest chain in which every word starts
+ * with the last letter of the word before it.
+ * best[c] holds the deepest chain seen so far that ends in letter c, as (depth, last word).
+ * A word w extends best[w.front()] (or starts a chain of depth 1) and replaces best[w.back()]
+ * only if it is strictly deeper, so an earlier word wins over a later one at equal depth.
+ * Each word records the word before it in its chain, which is all we need to rebuild the answer.
+ * This replaces the tree of std::map nodes: ALPHABET_SIZE fixed slots (62, or 31 with CASE_INSENSITIVE)
+ * plus one 4-byte back-pointer per word.
+ */
+class Chain_Table
+{
+    private:
+        struct Chain_End
         {
-            return parent == nullptr;
+            std::uint32_t depth = 0;
+            std::uint32_t word  = NO_WORD;
+        };
+
+        Chain_End                  best[ALPHABET_SIZE];
+        std::vector<std::uint32_t> parent; // parent[w]: the word before w in its chain, or NO_WORD
+
+    public:
+        explicit Chain_Table(const std::size_t _words_count)
+        {
+            parent.reserve(_words_count);
         }
 
-        bool Is_Leaf() const
+        // Words must be added in input order, with consecutive ids starting from 0.
+        void Add(const std::uint32_t _word, const unsigned int _first_letter, const unsigned int _last_letter)
+        {
+            assert(_word == parent.size());
+
+            if (_first_letter == ALPHABET_SIZE || _last_letter == ALPHABET_SIZE)
+            {
+                // Not a word; it can't be part of any chain.
+                parent.push_back(NO_WORD);
+                return;
+            }
+
+            const Chain_End& before = best[_first_letter];
+            const std::uint32_t depth = before.depth + 1;
+            parent.push_back(before.word);
+
+            if (depth > best[_last_letter].depth)
+            {
+                best[_last_letter] = {depth, _word};
+            }
+        }
+
+        // The deepest chain; on a tie, the one ending in the later letter.
+        std::uint32_t Best_Depth() const
+        {
+            return best[Best_Letter()].depth;
+        }
+
+        // Word ids of the deepest chain, first to last.
+        std::vector<std::uint32_t> Best_Chain() const
+        {
+            std::vector<std::uint32_t> chain;
+            for (std::uint32_t word = best[Best_Letter()].word; word != NO_WORD; word = parent[word])
+            {
+                chain.push_back(word);
+            }
+            std::reverse(chain.begin(), chain.end());
+
+            return chain;
+        }
+
+        std::size_t Memory_Usage() const
+        {
+            return sizeof(*this) + parent.capacity() * sizeof(std::uint32_t);
+        }
+
+    private:
+        unsigned int Best_Letter() const
+        {
+            unsigned int best_letter = 0;
+            for (unsigned int letter = 0; letter < ALPHABET_SIZE; letter++)
+            {
+                if (best[letter].depth >= best[best_letter].depth)
+                {
+                    best_letter = letter;
+                }
+            }
+
+            return best_letter;
+        }
+};
+
+// Splits _text on whitespace, like operator>> does.
+std::vector<Word_Span> split_words(const std::vector<char>& _text)
+{
+    std::vector<Word_Span> words; // max vector size is 20'000; max word size is 20
+
+    Tokenizer   tokenizer(_text.data(), _text.data() + _text.size());
+    String_View word;
+    while (tokenizer.Next_Word(word))
+    {
+        words.push_back({static_cast<std::uint32_t>(word.data - _text.data()), static_cast<std::uint32_t>(word.size)});
+    }
+
+    return words;
+}
+
+#ifdef STREAMING_INPUT
+constexpr std::size_t STREAM_BUFFER_SIZE = 1 << 16;
+
+/* Streaming_Chain: the Chain_Table DP fed one word at a time, without keeping the input.
+ * A word that does not become the deepest chain for its last letter can never be
+ * extended or be the answer, so it is counted and forgotten. A word that does is appended
+ * to a log as (back-pointer to the log entry of the word before it, its word id),
+ * and best[c] points into that log. The chain's word ids are rebuilt from the log at the end,
+ * and their text is picked up by a second read of the input.
+ * Memory is two 4-byte ids per logged word, and a fixed-size read buffer.
+ */
+class Streaming_Chain
+{
+    private:
+        struct Chain_End
         {
-            return children.empty();
+            std::uint32_t depth = 0;
+            std::uint32_t entry = NO_WORD;
+        };
+
+        struct Log_Entry
+        {
+            std::uint32_t parent; // log entry of the word before this one, or NO_WORD
+            std::uint32_t word;
+        };
+
+        Chain_End              best[ALPHABET_SIZE];
+        std::vector<Log_Entry> log;
+        std::uint32_t          words_count = 0;
+
+    public:
+        void Add(const String_View _word)
+        {
+            assert(words_count < NO_WORD);
+            const std::uint32_t word = words_count++;
+
+            const unsigned int first_letter = first_letter_index(_word.data, _word.size);
+            const unsigned int last_letter  = last_letter_index(_word.data, _word.size);
+            if (first_letter == ALPHABET_SIZE || last_letter == ALPHABET_SIZE)
+            {
+                // Not a word; it can't be part of any chain.
+                return;
+            }
+
+            const Chain_End&    before = best[first_letter];
+            const std::uint32_t depth  = before.depth + 1;
+            if (depth <= best[last_letter].depth)
+            {
+                return;
+            }
+
+            assert(log.size() < NO_WORD);
+            log.push_back({before.entry, word});
+            best[last_letter] = {depth, static_cast<std::uint32_t>(log.size() - 1)};
         }
 
-        // bool operator==(const Node& _rhs) const
-        // {
-        //     return word == _rhs.word;
-        // }
-        //
-        // bool operator!=(const Node& _rhs) const
-        // {
-        //     return word != _rhs.word;
-        // }
+        std::uint32_t Words_Count() const
+        {
+            return words_count;
+        }
 
-        bool operator<(const Node& _rhs) const
+        std::uint32_t Best_Depth() const
         {
-            return depth < _rhs.depth;
+            return best[Best_Letter()].depth;
         }
 
-        bool operator>(const Node& _rhs) const
+        // Word ids of the deepest chain, first to last.
+        std::vector<std::uint32_t> Best_Chain() const
         {
-            return depth > _rhs.depth;
+            std::vector<std::uint32_t> chain;
+            for (std::uint32_t entry = best[Best_Letter()].entry; entry != NO_WORD; entry = log[entry].parent)
+            {
+                chain.push_back(log[entry].word);
+            }
+            std::reverse(chain.begin(), chain.end());
+
+            return chain;
         }
 
-        bool operator<=(const Node& _rhs) const
+        std::size_t Memory_Usage() const
         {
-            return depth <= _rhs.depth;
+            return sizeof(*this) + log.capacity() * sizeof(Log_Entry);
         }
 
-        bool operator>=(const Node& _rhs) const
+    private:
+        // Same tie-break as Chain_Table: the chain ending in the later letter.
+        unsigned int Best_Letter() const
         {
-            return depth >= _rhs.depth;
+            unsigned int best_letter = 0;
+            for (unsigned int letter = 0; letter < ALPHABET_SIZE; letter++)
+            {
+                if (best[letter].depth >= best[best_letter].depth)
+                {
+                    best_letter = letter;
+                }
+            }
+
+            return best_letter;
         }
 };
 
-int main()
+/* Reads _input in STREAM_BUFFER_SIZE blocks and calls _word_handler(String_View)
+ * for every whitespace-separated word, in order.
+ * A word cut by the end of a block is carried over in a small side buffer.
+ */
+template <typename Word_Handler>
+void stream_words(std::istream& _input, Word_Handler&& _word_handler)
 {
-    #ifdef PROFILING
-    Profiling profiling = Profiling(__PRETTY_FUNCTION__);
-    #endif
+    std::vector<char> buffer(STREAM_BUFFER_SIZE);
+    std::string       carried_word;
 
-    IO& io = IO::GetInstance(INPUT_FILE_NAME, OUTPUT_FILE_NAME);
+    while (_input)
+    {
+        _input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        const char* const end      = buffer.data() + _input.gcount();
+        const char*       position = buffer.data();
 
-    // Dump the entire file into a buffer.
-    std::stringstream buffer;
-    buffer << io.IN.rdbuf();
+        while (position != end)
+        {
+            const char* const begin = position;
+            position                = find_space(position, end, true);
 
-    std::vector<std::string> words; // max vector size is 20'000; max word size is 20
+            if (position == end)
+            {
+                // The word may go on in the next block.
+                carried_word.append(begin, position);
+                break;
+            }
 
-    // Read the buffer word by word.
-    // We don't need to worry about case sensitivity.
-    while (buffer.eof() == false)
+            if (carried_word.empty() == false)
+            {
+                carried_word.append(begin, position);
+                _word_handler(String_View{carried_word.data(), carried_word.size()});
+                carried_word.clear();
+            }
+            else if (begin != position)
+            {
+                _word_handler(String_View{begin, static_cast<std::size_t>(position - begin)});
+            }
+
+            position = find_space(position, end, false);
+        }
+    }
+
+    if (carried_word.empty() == false)
     {
-        std::string line;
-        buffer >> line;
-        words.push_back(line);
+        _word_handler(String_View{carried_word.data(), carried_word.size()});
     }
+}
+#endif
+
+#ifdef PARALLEL_CHAIN
+#ifdef STREAMING_INPUT
+#error "PARALLEL_CHAIN splits up the text held in memory: it cannot be combined with STREAMING_INPUT"
+#endif
 
-    // We don't need the buffer any more.
-    // First we clear the state (set end-of-file flag to false).
-    buffer.clear();
-    // Then we clear the buffer.
-    buffer.str(std::string());
+// The text is cut into chunks of [MIN_CHUNK_SIZE, MAX_CHUNK_SIZE] bytes, CHUNKS_PER_THREAD per thread if it is big enough,
+// so that a thread that gets a slow chunk does not hold up the others.
+constexpr std::size_t MIN_CHUNK_SIZE    = 1 << 20;
+constexpr std::size_t MAX_CHUNK_SIZE    = 1 << 30;
+constexpr std::size_t CHUNKS_PER_THREAD = 4;
 
-    /* nodes_map <char, Node*>: holds the node with the highest depth
-     * It is worth noting that each ending letter could be a root node.
-     * Therefore, we have anywhere between one and 26 trees.
-     */
-    std::map<char, Node*> nodes_map;
+// ALPHABET_SIZE rounded up to whole 16-byte vectors.
+constexpr unsigned int LETTER_LANES = (ALPHABET_SIZE + 3) / 4 * 4;
+// A chunk of under 2^31 bytes has under 2^30 words, so adding 1 per word to UNREACHABLE keeps it negative.
+constexpr std::int32_t UNREACHABLE = INT32_MIN / 2;
 
-    for (std::string& word : words)
-    {
-        if (isalpha(word.front()) == false || isalpha(word.back()) == false)
+/* Chain_Transfer: what a run of words does to the depths in Chain_Table's best[], as a max-plus matrix.
+ * A word (first letter f, last letter l) takes depths d to d' with d'[l] = max(d[l], d[f] + 1),
+ * and such maps compose, so any run of words comes down to
+ * gain[j][i]: how much deeper the run can take a chain that ends in letter i before it, ending it in letter j.
+ * It is 0 for i == j (the run can leave a chain alone), and negative if no chain of the run gets from i to j.
+ * After the run, d'[j] = max over i of d[i] + gain[j][i].
+ */
+class Chain_Transfer
+{
+    private:
+        alignas(16) std::int32_t gain[ALPHABET_SIZE][LETTER_LANES];
+
+    public:
+        // The empty run.
+        Chain_Transfer()
         {
-            // TODO: can be removed in the final version
-            std::cerr << "Invalid word: " << word << std::endl;
-            continue;
+            for (unsigned int to = 0; to < ALPHABET_SIZE; to++)
+            {
+                for (unsigned int from = 0; from < LETTER_LANES; from++)
+                {
+                    gain[to][from] = to == from ? 0 : UNREACHABLE;
+                }
+            }
         }
 
-        Node* new_child_node = nullptr;
+        // Appends a word to the run: gain[l][i] = max(gain[l][i], gain[f][i] + 1), for every i at once.
+        void Add(const unsigned int _first_letter, const unsigned int _last_letter)
+        {
+            std::int32_t* const       to   = gain[_last_letter];
+            const std::int32_t* const from = gain[_first_letter];
 
-        /* First we need to deal with the start of the word.
-         * Can we plug this word into another node?
-         * If we can't, we need to add it to the root nodes.
-         */
-        if (nodes_map.find(word.front()) == nodes_map.end())
+            #ifdef __SSE2__
+            const __m128i one = _mm_set1_epi32(1);
+            for (unsigned int i = 0; i < LETTER_LANES; i += 4)
+            {
+                const __m128i old      = _mm_load_si128(reinterpret_cast<const __m128i*>(to + i));
+                const __m128i extended = _mm_add_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(from + i)), one);
+                // SSE2 has no 32-bit max: pick through a compare mask.
+                const __m128i greater = _mm_cmpgt_epi32(extended, old);
+                _mm_store_si128(reinterpret_cast<__m128i*>(to + i),
+                                _mm_or_si128(_mm_and_si128(greater, extended), _mm_andnot_si128(greater, old)));
+            }
+            #else
+            for (unsigned int i = 0; i < LETTER_LANES; i++)
+            {
+                to[i] = std::max(to[i], from[i] + 1);
+            }
+            #endif
+        }
+
+        // The depths after the run, from the depths before it.
+        void Apply(const std::uint32_t (&_before)[ALPHABET_SIZE], std::uint32_t (&_after)[ALPHABET_SIZE]) const
         {
-            /* There is nowhere to plug this node in.
-             * We need to check if another left node doesn't already have
-             * the same termination. If it does, we don't need this new word.
-             * Otherwise, we will add it to the root nodes.
-             */
+            for (unsigned int to = 0; to < ALPHABET_SIZE; to++)
+            {
+                std::uint32_t depth = 0;
+                for (unsigned int from = 0; from < ALPHABET_SIZE; from++)
+                {
+                    if (gain[to][from] >= 0)
+                    {
+                        depth = std::max(depth, _before[from] + static_cast<std::uint32_t>(gain[to][from]));
+                    }
+                }
+                _after[to] = depth;
+            }
         }
-        else
+};
+
+/* Parallel_Chain: Chain_Table's DP over a text cut into chunks, which are worked on by all hardware threads.
+ * 1. Every chunk sums up its words as a Chain_Transfer, independently of the others.
+ * 2. Running the depths through the transfers, one after another, gives the exact best[] depths
+ *    each chunk starts from. This is an ALPHABET_SIZE x ALPHABET_SIZE step per chunk, next to ALPHABET_SIZE steps per word in 1.
+ * 3. Every chunk runs the DP again from its starting depths. Its decisions are those of the sequential DP,
+ *    ties included, as they only compare depths; but a chain coming from before the chunk is known only
+ *    by the letter it ends in, until the chunks before it are done.
+ *    Like Streaming_Chain, a chunk only logs the words that become the deepest for their last letter.
+ * 4. Going through the chunks in order ties each one's incoming chains to the log entries they end in.
+ */
+class Parallel_Chain
+{
+    private:
+        // A log entry of a chunk.
+        struct Chain_Link
         {
-            /* We have a node ending with the same starting letter as our new word.
-             * We need to check if it already has a child with the same termination.
-             */
-            if (nodes_map[word.front()]->children.find(word.back()) != nodes_map[word.front()]->children.end())
+            std::uint32_t chunk = NO_WORD;
+            std::uint32_t entry = NO_WORD;
+        };
+
+        // Log entries from FROM_BEFORE on stand for the chain that ended in letter (entry - FROM_BEFORE) as the chunk began.
+        static constexpr std::uint32_t FROM_BEFORE = NO_WORD - ALPHABET_SIZE;
+
+        struct Chain_End
+        {
+            std::uint32_t depth;
+            std::uint32_t entry;
+        };
+
+        struct Log_Entry
+        {
+            std::uint32_t parent; // log entry of the word before this one, in this chunk or from before it
+            std::uint32_t begin;
+            std::uint32_t length;
+        };
+
+        struct Chunk
+        {
+            const char*            begin;
+            const char*            end;
+            std::uint32_t          words_count = 0;
+            Chain_Transfer         transfer;
+            std::uint32_t          depth_before[ALPHABET_SIZE];
+            Chain_Link             link_before[ALPHABET_SIZE];
+            Chain_End              best[ALPHABET_SIZE];
+            std::vector<Log_Entry> log;
+        };
+
+        const std::vector<char>& text;
+        std::vector<Chunk>       chunks;
+        std::uint32_t            words_count = 0;
+        std::uint32_t            depth_after[ALPHABET_SIZE] = {};
+        Chain_Link               link_after[ALPHABET_SIZE];
+
+        // Calls _work(chunk) for every chunk, on all hardware threads.
+        template <typename Chunk_Work>
+        void For_Each_Chunk(const Chunk_Work& _work)
+        {
+            std::atomic<std::size_t> next_chunk(0);
+            const auto               worker = [&]() {
+                for (std::size_t chunk = next_chunk++; chunk < chunks.size(); chunk = next_chunk++)
+                {
+                    _work(chunks[chunk]);
+                }
+            };
+
+            const std::size_t threads_count = std::max<std::size_t>(1, std::min<std::size_t>(std::thread::hardware_concurrency(), chunks.size()));
+            std::vector<std::thread> threads;
+            threads.reserve(threads_count);
+            for (std::size_t thread = 0; thread < threads_count; thread++)
             {
-                /* We already have a node with the same termination.
-                 * An earlier word is preferable than a later one.
-                 * We ignore this word.
-                 */
-                word.clear();
-                continue;
+                threads.emplace_back(worker);
             }
 
-            /* We don't have a node with the same termination.
-             * We prepare to add this word to the tree, pending no depth conflict.
-             */
-            new_child_node                                 = new Node(word, nodes_map[word.front()]);
-            nodes_map[word.front()]->children[word.back()] = new_child_node;
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
         }
 
-        /* We now know we are dealing with a node that is either pluggable
-         * (if new_child_node is not nullptr) or a root node.
-         * Now we need to deal with the end of the word.
-         */
-        if (nodes_map.find(word.back()) == nodes_map.end())
+        // Step 1.
+        static void Summarise(Chunk& _chunk)
         {
-            /* We don't have a node with the same termination,
-             * so we don't need to worry about competing depths.
-             */
-            if (new_child_node)
+            Tokenizer   tokenizer(_chunk.begin, _chunk.end);
+            String_View word;
+            while (tokenizer.Next_Word(word))
             {
-                // We have a new max depth for character word.back().
-                nodes_map[word.back()] = new_child_node;
+                _chunk.words_count++;
+
+                const unsigned int first_letter = first_letter_index(word.data, word.size);
+                const unsigned int last_letter  = last_letter_index(word.data, word.size);
+                if (first_letter != ALPHABET_SIZE && last_letter != ALPHABET_SIZE)
+                {
+                    _chunk.transfer.Add(first_letter, last_letter);
+                }
             }
-            else
+        }
+
+        // Step 3.
+        void Resolve(Chunk& _chunk) const
+        {
+            for (unsigned int letter = 0; letter < ALPHABET_SIZE; letter++)
             {
-                // New root node.
-                // We have a new max depth (of 1) for character word.back().
-                nodes_map[word.back()] = new Node(word, nullptr);
+                _chunk.best[letter] = {_chunk.depth_before[letter], FROM_BEFORE + letter};
+            }
+
+            Tokenizer   tokenizer(_chunk.begin, _chunk.end);
+            String_View word;
+            while (tokenizer.Next_Word(word))
+            {
+                const unsigned int first_letter = first_letter_index(word.data, word.size);
+                const unsigned int last_letter  = last_letter_index(word.data, word.size);
+                if (first_letter == ALPHABET_SIZE || last_letter == ALPHABET_SIZE)
+                {
+                    continue;
+                }
+
+                const Chain_End&    before = _chunk.best[first_letter];
+                const std::uint32_t depth  = before.depth + 1;
+                if (depth <= _chunk.best[last_letter].depth)
+                {
+                    continue;
+                }
+
+                _chunk.log.push_back({before.entry, static_cast<std::uint32_t>(word.data - text.data()), static_cast<std::uint32_t>(word.size)});
+                _chunk.best[last_letter] = {depth, static_cast<std::uint32_t>(_chunk.log.size() - 1)};
             }
         }
-        else
+
+        // The log entry that entry _entry of chunk _chunk stands for.
+        Chain_Link Link(const std::uint32_t _chunk, const std::uint32_t _entry) const
         {
-            /* We already have a node with the same termination.
-             * We need to check for competing depths.
-             */
+            return _entry >= FROM_BEFORE ? chunks[_chunk].link_before[_entry - FROM_BEFORE] : Chain_Link{_chunk, _entry};
+        }
 
-            if (new_child_node == nullptr)
+        // Same tie-break as Chain_Table: the chain ending in the later letter.
+        unsigned int Best_Letter() const
+        {
+            unsigned int best_letter = 0;
+            for (unsigned int letter = 0; letter < ALPHABET_SIZE; letter++)
             {
-                /* This is a root node, therefore its depth is 1.
-                 * No need to add it.
-                 */
-                continue;
+                if (depth_after[letter] >= depth_after[best_letter])
+                {
+                    best_letter = letter;
+                }
             }
 
-            if (nodes_map[word.back()]->depth < new_child_node->depth)
+            return best_letter;
+        }
+
+    public:
+        explicit Parallel_Chain(const std::vector<char>& _text) : text(_text)
+        {
+            assert(text.size() < FROM_BEFORE);
+
+            const std::size_t threads_count = std::max(1u, std::thread::hardware_concurrency());
+            const std::size_t chunk_size    = std::min(MAX_CHUNK_SIZE, std::max(MIN_CHUNK_SIZE, text.size() / (threads_count * CHUNKS_PER_THREAD)));
+            const char* const end           = text.data() + text.size();
+            for (const char* begin = text.data(); begin != end;)
             {
-                /* The new word provides us with a higher depth.
-                 * We need to and add the new one to the map
-                 * We do not delete the old one as it might still be parts
-                 * of another sequence.
-                 */
-                nodes_map[word.back()] = new_child_node;
+                // Chunks end on whitespace, so that no word is cut in two.
+                const char* const chunk_end = find_space(begin + std::min<std::size_t>(chunk_size, static_cast<std::size_t>(end - begin)), end, true);
+                chunks.emplace_back();
+                chunks.back().begin = begin;
+                chunks.back().end   = chunk_end;
+                begin               = chunk_end;
             }
-            else
+
+            For_Each_Chunk(&Summarise);
+
+            // Step 2; depth_after ends up as the depths after the whole text.
+            for (Chunk& chunk : chunks)
             {
-                /* Out new word has a lower depth.
-                 * We don't need to add it.
-                 * Not only that, but we need to remove it from the map.
-                 */
+                std::copy(std::begin(depth_after), std::end(depth_after), std::begin(chunk.depth_before));
+                chunk.transfer.Apply(chunk.depth_before, depth_after);
+                words_count += chunk.words_count;
+            }
+
+            For_Each_Chunk([this](Chunk& _chunk) { Resolve(_chunk); });
 
-                nodes_map[word.front()]->children.erase(word.back());
-                delete new_child_node;
+            // Step 4; link_after ends up as the chains ending the whole text.
+            for (std::uint32_t chunk = 0; chunk < chunks.size(); chunk++)
+            {
+                std::copy(std::begin(link_after), std::end(link_after), std::begin(chunks[chunk].link_before));
+                for (unsigned int letter = 0; letter < ALPHABET_SIZE; letter++)
+                {
+                    link_after[letter] = Link(chunk, chunks[chunk].best[letter].entry);
+                }
             }
         }
-    }
 
-    for (auto it = nodes_map.cbegin(); it != nodes_map.cend();)
-    {
-        /* Every node that is not a leaf by definition cannot be
-         * having the highest depth. We can remove it now.
-         */
-        if (it->second == nullptr || it->second->Is_Leaf() == false)
+        std::uint32_t Words_Count() const
         {
-            it = nodes_map.erase(it);
+            return words_count;
         }
-        else
+
+        std::uint32_t Best_Depth() const
         {
-            ++it;
+            return depth_after[Best_Letter()];
         }
-    }
 
-    unsigned int best_depth = 0;
-    const Node*  best_leaf  = nullptr;
-    for (const auto& [key, node] : nodes_map)
-    {
-        if (node->depth >= best_depth)
+        // The words of the deepest chain, first to last.
+        std::vector<String_View> Best_Chain() const
+        {
+            std::vector<String_View> chain;
+            for (Chain_Link link = link_after[Best_Letter()]; link.chunk != NO_WORD;)
+            {
+                const Log_Entry& entry = chunks[link.chunk].log[link.entry];
+                chain.push_back({text.data() + entry.begin, entry.length});
+                link = Link(link.chunk, entry.parent);
+            }
+            std::reverse(chain.begin(), chain.end());
+
+            return chain;
+        }
+
+        std::size_t Memory_Usage() const
         {
-            best_depth = node->depth;
-            best_leaf  = node;
+            std::size_t memory = sizeof(*this) + chunks.capacity() * sizeof(Chunk);
+            for (const Chunk& chunk : chunks)
+            {
+                memory += chunk.log.capacity() * sizeof(Log_Entry);
+            }
+
+            return memory;
         }
+};
+
+constexpr std::uint32_t Parallel_Chain::FROM_BEFORE;
+#endif
+
+int main()
+{
+    #ifdef PROFILING
+    Profiling profiling = Profiling(__PRETTY_FUNCTION__);
+    #endif
+
+    IO& io = IO::GetInstance(INPUT_FILE_NAME, OUTPUT_FILE_NAME);
+
+    #ifdef STREAMING_INPUT
+    // -DSTREAMING_INPUT: one pass over the input, which is never held in memory.
+    Streaming_Chain chain;
+    stream_words(io.IN, [&chain](const String_View _word) { chain.Add(_word); });
+
+    io.OUT << chain.Words_Count() << "\n";
+    io.OUT << chain.Words_Count() - chain.Best_Depth() << "\n";
+
+    // Second read of the input: write out the chain's words, whose ids come in increasing order.
+    const std::vector<std::uint32_t> best_chain = chain.Best_Chain();
+    std::size_t                      next_word  = 0;
+    std::uint32_t                    word       = 0;
+    io.IN.clear();
+    io.IN.seekg(0);
+    stream_words(io.IN, [&](const String_View _word) {
+        if (next_word < best_chain.size() && best_chain[next_word] == word)
+        {
+            io.OUT.write(_word.data, static_cast<std::streamsize>(_word.size));
+            io.OUT << "\n";
+            next_word++;
+        }
+        word++;
+    });
+
+    #ifdef PROFILING
+    profiling.End_Profiling();
+    std::cout << chain.Words_Count() << " words | memory: "
+              << STREAM_BUFFER_SIZE << " B read buffer + "
+              << chain.Memory_Usage() << " B chain log\n";
+    #endif
+    #else
+    // Dump the entire file into a buffer; words are slices of it.
+    const std::vector<char> text = read_file(io.IN);
+    assert(text.size() < NO_WORD);
+
+    #ifdef PARALLEL_CHAIN
+    // -DPARALLEL_CHAIN: the text is worked on in chunks, on all hardware threads.
+    const Parallel_Chain chain(text);
+
+    io.OUT << chain.Words_Count() << "\n";
+    io.OUT << chain.Words_Count() - chain.Best_Depth() << "\n";
+    for (const String_View word : chain.Best_Chain())
+    {
+        io.OUT.write(word.data, static_cast<std::streamsize>(word.size));
+        io.OUT << "\n";
     }
 
-    io.OUT << words.size() << "\n";
-    io.OUT << words.size() - best_depth << "\n";
-    const Node*             current_node = best_leaf;
-    std::stack<std::string> word_stack;
-    do
+    #ifdef PROFILING
+    profiling.End_Profiling();
+    std::cout << chain.Words_Count() << " words | memory: "
+              << text.capacity() << " B text + "
+              << chain.Memory_Usage() << " B chunks\n";
+    #endif
+    #else
+
+    const std::vector<Word_Span> words = split_words(text);
+
+    Chain_Table chain_table(words.size());
+    for (std::uint32_t word = 0; word < words.size(); word++)
     {
-        word_stack.push(current_node->word);
-        current_node = current_node->parent;
+        const char* const letters = text.data() + words[word].begin;
+        chain_table.Add(word, first_letter_index(letters, words[word].length), last_letter_index(letters, words[word].length));
     }
-    while (current_node);
 
-    while (word_stack.empty() == false)
+    io.OUT << words.size() << "\n";
+    io.OUT << words.size() - chain_table.Best_Depth() << "\n";
+    for (const std::uint32_t word : chain_table.Best_Chain())
     {
-        io.OUT << word_stack.top() << "\n";
-        word_stack.pop();
+        io.OUT.write(text.data() + words[word].begin, words[word].length);
+        io.OUT << "\n";
     }
 
     #ifdef PROFILING
     profiling.End_Profiling();
+    std::cout << words.size() << " words | memory: "
+              << text.capacity() << " B text + "
+              << words.capacity() * sizeof(Word_Span) << " B word spans + "
+              << chain_table.Memory_Usage() << " B chain table\n";
+    #endif
+    #endif
     #endif
 
     return 0;
@@ -1,11 +1,27 @@
+#include <algorithm>
 #include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <iostream>
-#include <sstream>
 #include <unordered_map>
 #include <vector>
 
+#ifdef OPTIMAL_JUSTIFICATION
+#include <deque>
+#endif
+
+#ifdef PARALLEL_JUSTIFICATION
+#include <atomic>
+#include <thread>
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #ifdef PROFILING
 #include <chrono>
 #endif
@@ -212,114 +228,784 @@ class Profiling
 };
 #endif
 
-int main()
+// Reads the whole stream into one buffer, in one go.
+std::vector<char> read_file(std::istream& _input)
 {
-    #ifdef PROFILING
-    Profiling profiling = Profiling(__PRETTY_FUNCTION__);
-    #endif
+    _input.seekg(0, std::ios::end);
+    const std::streamoff file_size = _input.tellg();
+    _input.seekg(0, std::ios::beg);
 
-    IO& io = IO::GetInstance(INPUT_FILE_NAME, OUTPUT_FILE_NAME);
+    std::vector<char> contents(static_cast<std::size_t>(file_size > 0 ? file_size : 0));
+    _input.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+
+    return contents;
+}
+
+/* String_View: a non-owning slice of a buffer (std::string_view is C++17).
+ * Tokens are handed out as views, so tokenising never copies or allocates.
+ */
+struct String_View
+{
+    const char* data = nullptr;
+    std::size_t size = 0;
+};
+
+std::ostream& operator<<(std::ostream& _output, const String_View _view)
+{
+    return _output.write(_view.data, static_cast<std::streamsize>(_view.size));
+}
 
-    // Read the entire file into a buffer.
-    std::stringstream buffer;
-    buffer << io.IN.rdbuf();
+// Whitespace as the "C" locale's isspace sees it: ' ', '\t', '\n', '\v', '\f', '\r'.
+inline bool is_space(const char _character)
+{
+    return _character == ' ' || static_cast<unsigned char>(_character - '\t') <= '\r' - '\t';
+}
 
-    int LINE_SETTING;
-    buffer >> LINE_SETTING;
-    buffer.ignore(); // Consume the newline character.
+#ifdef __SSE2__
+// Bit i is set if _block[i] is whitespace.
+inline unsigned int space_mask(const char* const _block)
+{
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_block));
+    // c - '\t' <= '\r' - '\t', as a signed compare after moving '\t' to -128.
+    const __m128i shifted = _mm_add_epi8(bytes, _mm_set1_epi8(0x80 - '\t'));
+    const __m128i control = _mm_cmplt_epi8(shifted, _mm_set1_epi8(-128 + ('\r' - '\t' + 1)));
+    return static_cast<unsigned int>(_mm_movemask_epi8(_mm_or_si128(control, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')))));
+}
+#endif
 
-    while (buffer.eof() == false)
+/* First position in [_from, _end) that is whitespace (_space) or is not (!_space).
+ * Tests 16 bytes at a time with SSE2, which every x86-64 has;
+ * words are a few bytes long, so wider vectors would rarely get to finish a block.
+ */
+const char* find_space(const char* _from, const char* const _end, const bool _space)
+{
+    #ifdef __SSE2__
+    for (; _from + 16 <= _end; _from += 16)
     {
-        std::string line;
-        getline(buffer, line);
+        const unsigned int mask = _space ? space_mask(_from) : ~space_mask(_from) & 0xFFFF;
+        if (mask)
+        {
+            return _from + __builtin_ctz(mask);
+        }
+    }
+    #endif
 
-        std::stringstream ss(line);
+    while (_from != _end && is_space(*_from) != _space)
+    {
+        _from++;
+    }
 
-        // Clear the string.
-        line.clear();
+    return _from;
+}
 
-        std::vector<std::string> words;
-        std::string              word;
+/* Tokenizer: splits a buffer into lines, and lines into whitespace-separated words.
+ * Lines are found with memchr, which the C library already vectorises.
+ */
+class Tokenizer
+{
+    private:
+        const char*       position;
+        const char* const end;
 
-        words.emplace_back("");
-        while (ss >> word)
+    public:
+        Tokenizer(const char* const _begin, const char* const _end) : position(_begin), end(_end) {}
+
+        explicit Tokenizer(const String_View _text) : Tokenizer(_text.data, _text.data + _text.size) {}
+
+        // Moves to the next line, without its '\n'; returns false when there is none left.
+        // A '\n' that ends the buffer does not start another (empty) line.
+        bool Next_Line(String_View& _line)
         {
-            words.push_back(word);
+            if (position == end)
+            {
+                return false;
+            }
+
+            const void* const newline  = std::memchr(position, '\n', static_cast<std::size_t>(end - position));
+            const char* const line_end = newline ? static_cast<const char*>(newline) : end;
+            _line                      = {position, static_cast<std::size_t>(line_end - position)};
+            position                   = newline ? line_end + 1 : end;
+            return true;
+        }
+
+        // Moves to the next word; returns false when there is none left.
+        bool Next_Word(String_View& _word)
+        {
+            const char* const begin = find_space(position, end, false);
+            if (begin == end)
+            {
+                position = end;
+                return false;
+            }
+
+            position = find_space(begin, end, true);
+            _word    = {begin, static_cast<std::size_t>(position - begin)};
+            return true;
         }
+};
 
-        // Clear the stringstream.
-        ss.clear();
-        ss.str(std::string());
+constexpr std::size_t OUTPUT_BUFFER_SIZE = 1 << 16;
 
-        unsigned int current_line_char_length = words[1].size();
-        unsigned int current_line_start_index = 1;
-        bool         final_word_printed       = false;
-        for (unsigned int i = 2; i < words.size(); i++)
+/* Output_Buffer: justified lines are assembled here with memcpy for words and memset for runs of spaces,
+ * and written out in OUTPUT_BUFFER_SIZE blocks, instead of one stream call per word and per space.
+ * Without a stream, it just grows and keeps everything (for paragraphs justified on other threads).
+ */
+class Output_Buffer
+{
+    private:
+        std::ostream*     output = nullptr;
+        std::vector<char> buffer;
+        std::size_t       used = 0;
+
+        // Makes room for _count more bytes: by flushing to the stream, or else by growing.
+        void Make_Room(const std::size_t _count)
         {
-            std::string& current_word = words[i];
+            if (used + _count <= buffer.size())
+            {
+                return;
+            }
 
-            if ((i + 1) == words.size())
+            Flush();
+            if (used + _count > buffer.size())
             {
-                if (current_line_char_length + current_word.size() + 1 <= LINE_SETTING)
+                buffer.resize(std::max(2 * buffer.size(), used + _count));
+            }
+        }
+
+    public:
+        explicit Output_Buffer(std::ostream& _output) : output(&_output), buffer(OUTPUT_BUFFER_SIZE) {}
+
+        // Starts empty, as there may be one per task.
+        Output_Buffer() = default;
+
+        ~Output_Buffer()
+        {
+            Flush();
+        }
+
+        Output_Buffer(const Output_Buffer&)            = delete;
+        Output_Buffer& operator=(const Output_Buffer&) = delete;
+
+        void Append(const String_View _word)
+        {
+            Make_Room(_word.size);
+            std::memcpy(buffer.data() + used, _word.data, _word.size);
+            used += _word.size;
+        }
+
+        void Append_Spaces(const std::size_t _count)
+        {
+            Make_Room(_count);
+            std::memset(buffer.data() + used, ' ', _count);
+            used += _count;
+        }
+
+        void End_Line()
+        {
+            Make_Room(1);
+            buffer[used++] = '\n';
+        }
+
+        // Writes out what the buffer holds, if it has a stream to write to.
+        void Flush()
+        {
+            if (output)
+            {
+                output->write(buffer.data(), static_cast<std::streamsize>(used));
+                used = 0;
+            }
+        }
+
+        // Everything not yet flushed.
+        String_View Contents() const
+        {
+            return {buffer.data(), used};
+        }
+};
+
+#ifdef OPTIMAL_JUSTIFICATION
+/* Minimum raggedness justification (Knuth-Plass without hyphenation or stretch penalties).
+ * Breaking the paragraph into lines costs the sum of (width - line length)^2 over every line but the last;
+ * the last line is free as long as it fits. A word longer than the width goes on a line of its own at no cost.
+ * best[j] is the cheapest way to set the first j words, taken over the last line's first word i:
+ * best[j] = min best[i] + cost(i, j). cost satisfies the quadrangle inequality (with +inf for lines
+ * that do not fit, which only grow when the line does), so the optimal i never decreases as j grows.
+ * Candidates are kept in a deque, each owning the range of j it is best for; a new candidate
+ * takes over a suffix of that range, found by binary search. O(n log n) instead of the O(n^2) DP.
+ */
+class Optimal_Justifier
+{
+    private:
+        using Cost = unsigned long long;
+
+        static constexpr Cost INFEASIBLE = ULLONG_MAX / 4;
+
+        const String_View*       words;
+        const std::size_t        words_count;
+        const std::size_t        width;
+        std::vector<std::size_t> prefix_length; // prefix_length[i]: length of words [0, i) with one space after each
+        std::vector<Cost>        best;
+        std::vector<std::size_t> line_start;    // line_start[j]: first word of the last line in the best setting of [0, j)
+
+        // Length of the line holding words [_first, _last).
+        std::size_t Line_Length(const std::size_t _first, const std::size_t _last) const
+        {
+            return prefix_length[_last] - prefix_length[_first] - 1;
+        }
+
+        Cost Line_Cost(const std::size_t _first, const std::size_t _last) const
+        {
+            const std::size_t length = Line_Length(_first, _last);
+            if (length > width)
+            {
+                return _last == _first + 1 ? 0 : INFEASIBLE;
+            }
+
+            return static_cast<Cost>(width - length) * (width - length);
+        }
+
+        Cost Total_Cost(const std::size_t _first, const std::size_t _last) const
+        {
+            return std::min(INFEASIBLE, best[_first] + Line_Cost(_first, _last));
+        }
+
+        struct Candidate
+        {
+            std::size_t first; // first word of the last line
+            std::size_t from;  // the smallest j this candidate is best for
+        };
+
+    public:
+        Optimal_Justifier(const String_View* const _words, const std::size_t _words_count, const std::size_t _width)
+            : words(_words), words_count(_words_count), width(_width),
+              prefix_length(_words_count + 1, 0), best(_words_count + 1, INFEASIBLE), line_start(_words_count + 1, 0)
+        {
+            for (std::size_t i = 0; i < words_count; i++)
+            {
+                prefix_length[i + 1] = prefix_length[i] + words[i].size + 1;
+            }
+
+            best[0] = 0;
+
+            // best[words_count] is left to the last line, which has a different cost.
+            std::deque<Candidate> candidates;
+            candidates.push_back({0, 1});
+            for (std::size_t j = 1; j < words_count; j++)
+            {
+                while (candidates.size() > 1 && candidates[1].from <= j)
+                {
+                    candidates.pop_front();
+                }
+
+                line_start[j] = candidates.front().first;
+                best[j]       = Total_Cost(line_start[j], j);
+
+                // j as the first word of the last line, from the line ending at word j + 1 on.
+                while (candidates.empty() == false && candidates.back().from > j &&
+                       Total_Cost(j, candidates.back().from) <= Total_Cost(candidates.back().first, candidates.back().from))
+                {
+                    candidates.pop_back();
+                }
+
+                if (candidates.empty())
+                {
+                    candidates.push_back({j, j + 1});
+                    continue;
+                }
+
+                // The first end in (back.from, words_count) where j is at least as good as the back candidate.
+                std::size_t low  = std::max(candidates.back().from, j + 1);
+                std::size_t high = words_count;
+                while (low < high)
                 {
-                    for (unsigned int j = current_line_start_index; j < i; j++)
+                    const std::size_t middle = low + (high - low) / 2;
+                    if (Total_Cost(j, middle) <= Total_Cost(candidates.back().first, middle))
                     {
-                        io.OUT << words[j] << " ";
+                        high = middle;
+                    }
+                    else
+                    {
+                        low = middle + 1;
                     }
-                    io.OUT << words[i] << "\n";
-                    final_word_printed = true;
-                    break;
                 }
-                final_word_printed = false;
+
+                if (low < words_count)
+                {
+                    candidates.push_back({j, low});
+                }
             }
 
-            if (current_line_char_length + current_word.size() + 1 > LINE_SETTING)
+            // The last line: any start that fits (or a single word) will do, at no cost.
+            line_start[words_count] = words_count - 1;
+            best[words_count]       = best[words_count - 1];
+            for (std::size_t first = words_count - 1; first-- > 0 && Line_Length(first, words_count) <= width;)
             {
-                if (i == current_line_start_index + 1)
+                if (best[first] <= best[words_count])
                 {
-                    io.OUT << words[current_line_start_index] << "\n";
-                    current_line_start_index = i;
-                    current_line_char_length = current_word.size();
-                    continue;
+                    best[words_count]       = best[first];
+                    line_start[words_count] = first;
                 }
+            }
+        }
 
-                unsigned int space_between_words = (LINE_SETTING - current_line_char_length + 1) /
-                                                   (i - current_line_start_index);
-                unsigned int more_space_instances = (LINE_SETTING - current_line_char_length + 1) %
-                                                    (i - current_line_start_index);
+        // The cost of the best setting: the sum of squared slack over all lines but the last.
+        Cost Raggedness() const
+        {
+            return best[words_count];
+        }
 
-                for (unsigned int j = current_line_start_index; j + 1 < i; j++)
+        // Writes the paragraph: full lines padded to the width, extra spaces leftmost; the last line left aligned.
+        void Write(Output_Buffer& _output) const
+        {
+            std::vector<std::size_t> breaks;
+            for (std::size_t last = words_count; last > 0; last = line_start[last])
+            {
+                breaks.push_back(last);
+            }
+            breaks.push_back(0);
+
+            for (std::size_t line = breaks.size() - 1; line > 0; line--)
+            {
+                const std::size_t first = breaks[line];
+                const std::size_t last  = breaks[line - 1];
+                const std::size_t gaps  = last - first - 1;
+                const std::size_t slack = last == words_count || gaps == 0 ? 0 : width - Line_Length(first, last);
+
+                for (std::size_t i = first; i + 1 < last; i++)
                 {
-                    io.OUT << words[j] << " ";
+                    const std::size_t gap = i - first;
+                    _output.Append(words[i]);
+                    _output.Append_Spaces(1 + slack / gaps + (gap < slack % gaps));
+                }
+                _output.Append(words[last - 1]);
+                _output.End_Line();
+            }
+        }
+};
 
-                    for (unsigned int k = 1; k <= space_between_words; k++)
+constexpr Optimal_Justifier::Cost Optimal_Justifier::INFEASIBLE;
+#endif
+
+/* Justifies one paragraph (one input line) to _line_setting columns.
+ * _words is scratch space, kept by the caller so that its capacity is reused across paragraphs.
+ */
+void justify_paragraph(const String_View _paragraph, const int _line_setting, std::vector<String_View>& _words, Output_Buffer& _output)
+{
+    Tokenizer   line_words(_paragraph);
+    String_View word;
+
+    _words.clear();
+    _words.emplace_back();
+    while (line_words.Next_Word(word))
+    {
+        _words.push_back(word);
+    }
+
+    if (_words.size() == 1)
+    {
+        // An empty paragraph.
+        _output.End_Line();
+        return;
+    }
+
+    #ifdef OPTIMAL_JUSTIFICATION
+    // -DOPTIMAL_JUSTIFICATION: minimum raggedness line breaks instead of the greedy ones below.
+    const Optimal_Justifier justifier(_words.data() + 1, _words.size() - 1, static_cast<std::size_t>(_line_setting));
+    justifier.Write(_output);
+    return;
+    #endif
+
+    unsigned int current_line_char_length = _words[1].size;
+    unsigned int current_line_start_index = 1;
+    bool         final_word_printed       = false;
+    for (unsigned int i = 2; i < _words.size(); i++)
+    {
+        const String_View current_word = _words[i];
+
+        if ((i + 1) == _words.size())
+        {
+            if (current_line_char_length + current_word.size + 1 <= _line_setting)
+            {
+                for (unsigned int j = current_line_start_index; j < i; j++)
+                {
+                    _output.Append(_words[j]);
+                    _output.Append_Spaces(1);
+                }
+                _output.Append(_words[i]);
+                _output.End_Line();
+                final_word_printed = true;
+                break;
+            }
+            final_word_printed = false;
+        }
+
+        if (current_line_char_length + current_word.size + 1 > _line_setting)
+        {
+            if (i == current_line_start_index + 1)
+            {
+                _output.Append(_words[current_line_start_index]);
+                _output.End_Line();
+                current_line_start_index = i;
+                current_line_char_length = current_word.size;
+                continue;
+            }
+
+            unsigned int space_between_words = (_line_setting - current_line_char_length + 1) /
+                                               (i - current_line_start_index);
+            unsigned int more_space_instances = (_line_setting - current_line_char_length + 1) %
+                                                (i - current_line_start_index);
+
+            for (unsigned int j = current_line_start_index; j + 1 < i; j++)
+            {
+                _output.Append(_words[j]);
+                _output.Append_Spaces(1 + space_between_words + (more_space_instances > 0));
+
+                if (more_space_instances > 0)
+                {
+                    more_space_instances--;
+                }
+            }
+
+            _output.Append(_words[i - 1]);
+            _output.End_Line();
+
+            current_line_start_index = i;
+            current_line_char_length = current_word.size + 1;
+        }
+        else
+        {
+            current_line_char_length += current_word.size + 1;
+        }
+    }
+
+    if (final_word_printed == false)
+    {
+        _output.Append(_words.back());
+        _output.End_Line();
+    }
+}
+
+#ifdef STREAMING_INPUT
+#if defined(OPTIMAL_JUSTIFICATION) || defined(PARALLEL_JUSTIFICATION)
+#error "STREAMING_INPUT justifies greedily on one thread: it cannot be combined with OPTIMAL_JUSTIFICATION or PARALLEL_JUSTIFICATION"
+#endif
+
+constexpr std::size_t STREAM_BUFFER_SIZE = 1 << 16;
+
+/* Streaming_Justifier: the greedy of justify_paragraph, fed one word at a time.
+ * It holds only the words of the line being built, plus the latest word: whether that one is
+ * the paragraph's last changes how it is set, so it waits until the next word or the end of the paragraph.
+ * A line holds at most _line_setting characters, unless it is a single longer word,
+ * so memory is O(_line_setting + longest word) however long the paragraph is.
+ */
+class Streaming_Justifier
+{
+    private:
+        const int      line_setting;
+        Output_Buffer& output;
+
+        std::vector<char>        line_text; // the words of the current line, back to back
+        std::vector<std::size_t> line_ends; // where each of them ends in line_text
+        std::vector<char>        pending;
+        bool                     has_pending              = false;
+        unsigned int             current_line_char_length = 0;
+        bool                     final_word_printed       = false;
+
+        String_View Line_Word(const std::size_t _index) const
+        {
+            const std::size_t begin = _index ? line_ends[_index - 1] : 0;
+            return {line_text.data() + begin, line_ends[_index] - begin};
+        }
+
+        void Start_Line(const String_View _word)
+        {
+            line_text.assign(_word.data, _word.data + _word.size);
+            line_ends.assign(1, _word.size);
+        }
+
+        void Push_Word(const String_View _word)
+        {
+            line_text.insert(line_text.end(), _word.data, _word.data + _word.size);
+            line_ends.push_back(line_text.size());
+        }
+
+        // One step of justify_paragraph's loop, for _word; _last if it ends the paragraph.
+        void Set_Word(const String_View _word, const bool _last)
+        {
+            if (line_ends.empty())
+            {
+                Start_Line(_word);
+                current_line_char_length = static_cast<unsigned int>(_word.size);
+                final_word_printed       = false;
+                return;
+            }
+
+            if (_last)
+            {
+                if (current_line_char_length + _word.size + 1 <= static_cast<std::size_t>(line_setting))
+                {
+                    for (std::size_t j = 0; j < line_ends.size(); j++)
                     {
-                        io.OUT << " ";
+                        output.Append(Line_Word(j));
+                        output.Append_Spaces(1);
                     }
+                    output.Append(_word);
+                    output.End_Line();
+                    final_word_printed = true;
+                    return;
+                }
+                final_word_printed = false;
+            }
+
+            if (current_line_char_length + _word.size + 1 > static_cast<std::size_t>(line_setting))
+            {
+                const unsigned int line_words = static_cast<unsigned int>(line_ends.size());
+                if (line_words == 1)
+                {
+                    output.Append(Line_Word(0));
+                    output.End_Line();
+                    Start_Line(_word);
+                    current_line_char_length = static_cast<unsigned int>(_word.size);
+                    return;
+                }
+
+                const unsigned int free_space           = static_cast<unsigned int>(line_setting) - current_line_char_length + 1;
+                const unsigned int space_between_words  = free_space / line_words;
+                unsigned int       more_space_instances = free_space % line_words;
+
+                for (unsigned int j = 0; j + 1 < line_words; j++)
+                {
+                    output.Append(Line_Word(j));
+                    output.Append_Spaces(1 + space_between_words + (more_space_instances > 0));
 
                     if (more_space_instances > 0)
                     {
-                        io.OUT << " ";
                         more_space_instances--;
                     }
                 }
 
-                io.OUT << words[i - 1] << "\n";
+                output.Append(Line_Word(line_words - 1));
+                output.End_Line();
 
-                current_line_start_index = i;
-                current_line_char_length = current_word.size() + 1;
+                Start_Line(_word);
+                current_line_char_length = static_cast<unsigned int>(_word.size) + 1;
             }
             else
             {
-                current_line_char_length += current_word.size() + 1;
+                Push_Word(_word);
+                current_line_char_length += static_cast<unsigned int>(_word.size) + 1;
+            }
+        }
+
+    public:
+        Streaming_Justifier(const int _line_setting, Output_Buffer& _output) : line_setting(_line_setting), output(_output) {}
+
+        // The next word of the current paragraph.
+        void Add_Word(const String_View _word)
+        {
+            if (has_pending)
+            {
+                Set_Word({pending.data(), pending.size()}, false);
             }
+
+            pending.assign(_word.data, _word.data + _word.size);
+            has_pending = true;
         }
 
-        if (final_word_printed == false)
+        void End_Paragraph()
+        {
+            if (has_pending == false)
+            {
+                // An empty paragraph.
+                output.End_Line();
+                return;
+            }
+
+            Set_Word({pending.data(), pending.size()}, true);
+            if (final_word_printed == false)
+            {
+                // The last word, alone on the current line.
+                output.Append(Line_Word(0));
+                output.End_Line();
+            }
+
+            line_text.clear();
+            line_ends.clear();
+            has_pending = false;
+        }
+};
+
+/* Reads _input in STREAM_BUFFER_SIZE blocks and calls _word_handler(String_View) for each word,
+ * and _line_handler() at the end of each line, as Tokenizer::Next_Line splits them.
+ * Words are views into the block, or into a carried copy for a word cut by the end of a block.
+ */
+template <typename Word_Handler, typename Line_Handler>
+void stream_words(std::istream& _input, Word_Handler&& _word_handler, Line_Handler&& _line_handler)
+{
+    std::vector<char> buffer(STREAM_BUFFER_SIZE);
+    std::string       carried_word;
+    bool              line_open = false; // something was read since the last '\n'
+
+    while (_input)
+    {
+        _input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        const char* const end      = buffer.data() + _input.gcount();
+        const char*       position = buffer.data();
+        if (position != end)
+        {
+            line_open = end[-1] != '\n';
+        }
+
+        while (position != end)
+        {
+            const char* const begin = position;
+            position                = find_space(position, end, true);
+
+            if (position == end)
+            {
+                // The word may go on in the next block.
+                carried_word.append(begin, position);
+                break;
+            }
+
+            if (carried_word.empty() == false)
+            {
+                carried_word.append(begin, position);
+                _word_handler(String_View{carried_word.data(), carried_word.size()});
+                carried_word.clear();
+            }
+            else if (begin != position)
+            {
+                _word_handler(String_View{begin, static_cast<std::size_t>(position - begin)});
+            }
+
+            const char* const spaces_end = find_space(position, end, false);
+            while (const void* const newline = std::memchr(position, '\n', static_cast<std::size_t>(spaces_end - position)))
+            {
+                _line_handler();
+                position = static_cast<const char*>(newline) + 1;
+            }
+            position = spaces_end;
+        }
+    }
+
+    if (carried_word.empty() == false)
+    {
+        _word_handler(String_View{carried_word.data(), carried_word.size()});
+    }
+    if (line_open)
+    {
+        _line_handler();
+    }
+}
+#endif
+
+#ifdef PARALLEL_JUSTIFICATION
+// Paragraphs are handed to threads in tasks of roughly this many input bytes.
+constexpr std::size_t TASK_SIZE = 1 << 18;
+
+/* Justifies _paragraphs on a pool of threads, each task into its own Output_Buffer, then writes the buffers in order.
+ * Paragraphs are independent, so the output is byte-identical to justifying them one after another.
+ * A task is a run of consecutive paragraphs of about TASK_SIZE input bytes. Threads take the next task
+ * from a shared counter, so one huge paragraph does not leave the other threads idle behind a fixed split.
+ */
+void justify_in_parallel(const std::vector<String_View>& _paragraphs, const int _line_setting, std::ostream& _output)
+{
+    std::vector<std::size_t> task_starts; // task t holds paragraphs [task_starts[t], task_starts[t + 1])
+    std::size_t              task_bytes = 0;
+    for (std::size_t paragraph = 0; paragraph < _paragraphs.size(); paragraph++)
+    {
+        if (task_starts.empty() || task_bytes >= TASK_SIZE)
         {
-            io.OUT << words.back() << "\n";
+            task_starts.push_back(paragraph);
+            task_bytes = 0;
         }
+        task_bytes += _paragraphs[paragraph].size + 1;
+    }
+    const std::size_t tasks_count = task_starts.size();
+    task_starts.push_back(_paragraphs.size());
+
+    std::vector<Output_Buffer> outputs(tasks_count);
+    std::atomic<std::size_t>   next_task(0);
+    const auto                 worker = [&]() {
+        std::vector<String_View> words;
+        for (std::size_t task = next_task++; task < tasks_count; task = next_task++)
+        {
+            for (std::size_t paragraph = task_starts[task]; paragraph < task_starts[task + 1]; paragraph++)
+            {
+                justify_paragraph(_paragraphs[paragraph], _line_setting, words, outputs[task]);
+            }
+        }
+    };
+
+    const std::size_t threads_count = std::max<std::size_t>(1, std::min<std::size_t>(std::thread::hardware_concurrency(), tasks_count));
+    std::vector<std::thread> threads;
+    threads.reserve(threads_count);
+    for (std::size_t thread = 0; thread < threads_count; thread++)
+    {
+        threads.emplace_back(worker);
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const Output_Buffer& output : outputs)
+    {
+        _output << output.Contents();
     }
+}
+#endif
+
+int main()
+{
+    #ifdef PROFILING
+    Profiling profiling = Profiling(__PRETTY_FUNCTION__);
+    #endif
+
+    IO& io = IO::GetInstance(INPUT_FILE_NAME, OUTPUT_FILE_NAME);
+
+    #ifdef STREAMING_INPUT
+    // -DSTREAMING_INPUT: one pass over the input, which is never held in memory,
+    // and each line is written as soon as it is complete.
+    std::string setting;
+    std::getline(io.IN, setting);
+    const int LINE_SETTING = std::atoi(setting.c_str());
+
+    Output_Buffer       output(io.OUT);
+    Streaming_Justifier justifier(LINE_SETTING, output);
+    stream_words(
+        io.IN, [&](const String_View _word) { justifier.Add_Word(_word); }, [&]() { justifier.End_Paragraph(); });
+    output.Flush();
+    #else
+    // Read the entire file into a buffer; lines and words are views into it.
+    const std::vector<char> buffer = read_file(io.IN);
+    Tokenizer               lines(buffer.data(), buffer.data() + buffer.size());
+
+    String_View line;
+    lines.Next_Line(line);
+    const int LINE_SETTING = std::atoi(std::string(line.data, line.size).c_str());
+
+    #ifdef PARALLEL_JUSTIFICATION
+    // -DPARALLEL_JUSTIFICATION: paragraphs are justified on all hardware threads.
+    std::vector<String_View> paragraphs;
+    while (lines.Next_Line(line))
+    {
+        paragraphs.push_back(line);
+    }
+    justify_in_parallel(paragraphs, LINE_SETTING, io.OUT);
+    #else
+    Output_Buffer            output(io.OUT);
+    std::vector<String_View> words;
+    while (lines.Next_Line(line))
+    {
+        justify_paragraph(line, LINE_SETTING, words, output);
+    }
+
+    output.Flush();
+    #endif
+    #endif
 
     #ifdef PROFILING
     profiling.End_Profiling();